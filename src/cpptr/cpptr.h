@@ -1,13 +1,29 @@
 #pragma once
 
+#include <algorithm>
 #include <cassert>
+#include <cctype>
+#include <cstdint>
 #include <cstring>
+#include <cmath>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <shared_mutex>
 #include <tuple>
+#include <array>
 #include <functional>
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <atomic>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 template<typename _Ty>
 using remove_cvref_t = std::remove_cv_t<std::remove_reference_t<_Ty>>;
@@ -62,6 +78,8 @@ public:
     qualifier_.con_ = top_qualifier_.con_ || ref_qualifier_.con_;
     qualifier_.vol_ = top_qualifier_.vol_ || ref_qualifier_.vol_;
 
+    access_idx_ = (qualifier_.con_ ? 1 : 0) | (qualifier_.vol_ ? 2 : 0) | (category_ != val_category::lval ? 4 : 0);
+
     init_hash_and_ptr_qualifiers<std::remove_cv_t<unref_t>>();
   }
 
@@ -118,6 +136,37 @@ public:
     return category_;
   }
 
+  // const, volatile and rvalue packed as bits 0, 1 and 2
+  size_t get_access_index() const
+  {
+    return access_idx_;
+  }
+
+  // cost of converting to _dest, only meaningful when can_conv_to(_dest) holds, 0 means exact match
+  size_t conv_rank(const type_desc &_dest) const
+  {
+    if (this == &_dest)
+      return 0;
+
+    size_t rank = 0;
+    if (category_ != _dest.category_)
+      ++rank;
+
+    if (_dest.category_ != val_category::prval)
+      rank += (qualifier_.con_ != _dest.qualifier_.con_) + (qualifier_.vol_ != _dest.qualifier_.vol_);
+
+    for (size_t i = 0; i < ptr_qualifiers_.size(); ++i)
+    {
+      auto &sq = ptr_qualifiers_[i], &dq = _dest.ptr_qualifiers_[i];
+      rank += (sq.con_ != dq.con_) + (sq.vol_ != dq.vol_);
+    }
+
+    if (hash_ != _dest.hash_)
+      ++rank;
+
+    return rank;
+  }
+
 private:
   template<typename _Ty>
   void init_hash_and_ptr_qualifiers()
@@ -133,6 +182,7 @@ private:
   }
 
   size_t hash_ = 0;
+  size_t access_idx_ = 0;
   val_category category_ = val_category::lval;
   cv_qualifier top_qualifier_;
   cv_qualifier ref_qualifier_;
@@ -166,18 +216,23 @@ public:
   result() = default;
 
   template <typename _Ty>
-  result(_Ty &&_val) : null_(false), desc_(&get_type_desc<_Ty &&>())
+  result(_Ty &&_val) : result(type_wrapper<_Ty &&>{}, std::forward<_Ty>(_val))
+  {}
+
+  // _Ty is the declared type of the value, a returned prvalue would be deduced as an xvalue otherwise
+  template <typename _Ty, typename _Val>
+  result(type_wrapper<_Ty>, _Val &&_val) : null_(false), desc_(&get_type_desc<_Ty>())
   {
     using unref_t = std::remove_reference_t<_Ty>;
 
-    if (desc_->get_val_category() != val_category::prval)
+    if constexpr (std::is_reference_v<_Ty>)
       ptr_ = (void*)&_val;
     else if constexpr (std::is_trivially_copyable_v<unref_t> && sizeof(unref_t) <= blk_sz)
       memcpy(&blk_, (void*)&_val, sizeof(unref_t));
     else
     {
       alloc_ = &obj_alloc_<unref_t>;
-      ptr_ = (void *)new unref_t(std::forward<_Ty>(_val));
+      ptr_ = (void *)new unref_t(std::forward<_Val>(_val));
     }
   }
 
@@ -239,6 +294,15 @@ public:
     return (_Ty)val;
   }
 
+  // the value in place, nullptr if null
+  void *get_address()
+  {
+    if (null_)
+      return nullptr;
+
+    return ptr_ ? ptr_ : (void *)&blk_;
+  }
+
   void swap(result & _other)
   {
     std::swap(null_, _other.null_);
@@ -304,6 +368,13 @@ struct fn_traits<_Ret(_Args...)>
 
   using fn_t = _Ret(*)(_Args...);
 
+  static const std::array<const type_desc *, arg_cnt> &get_arg_descs()
+  {
+    // thread-safe
+    static std::array<const type_desc *, arg_cnt> descs = { &get_type_desc<_Args>()... };
+    return descs;
+  }
+
   static result invoke_fn(...)
   {
     // can't reach here
@@ -320,9 +391,7 @@ struct fn_traits<_Ret(_Args...)>
   template<typename _Fn, typename _TupArgs, size_t... _Idxs>
   static result invoke_fn(_Fn _fn, _TupArgs &&_args, std::index_sequence<_Idxs...>)
   {
-    std::vector<std::pair<const type_desc &, const type_desc &>> descs = { {get_type_desc<arg_t<_Idxs>>(), std::get<_Idxs>(_args).desc_}... };
-    for (auto &p : descs)
-      assert(p.second.can_conv_to(p.first));
+    assert((std::get<_Idxs>(_args).desc_.can_conv_to(get_type_desc<arg_t<_Idxs>>()) && ...));
 
     if constexpr (std::is_void_v<_Ret>)
     {
@@ -330,7 +399,7 @@ struct fn_traits<_Ret(_Args...)>
       return result();
     }
     else
-      return std::invoke(_fn, std::forward<arg_t<_Idxs>>((std::add_lvalue_reference_t<arg_t<_Idxs>>) * (std::remove_reference_t<arg_t<_Idxs>> *)std::get<_Idxs>(_args).ptr_)...);
+      return result(type_wrapper<_Ret>{}, std::invoke(_fn, std::forward<arg_t<_Idxs>>((std::add_lvalue_reference_t<arg_t<_Idxs>>) * (std::remove_reference_t<arg_t<_Idxs>> *)std::get<_Idxs>(_args).ptr_)...));
   }
 };
 
@@ -354,10 +423,72 @@ template <typename _Ret, typename _Cls, typename... _Args>
 struct fn_traits<_Ret(_Cls:: *)(_Args...) volatile const> : fn_traits<_Ret(volatile const _Cls &, _Args...)>
 {};
 
+enum class scalar_kind
+{
+  none, boolean, integer, unsigned_integer, floating
+};
+
+// an arithmetic value widened to 64 bits, unsigned 64-bit values keep their own kind so they don't read as negative
+union scalar
+{
+  int64_t i_;
+  uint64_t u_;
+  double d_;
+};
+
+template <typename _Ty>
+constexpr scalar_kind get_scalar_kind()
+{
+  if constexpr (std::is_same_v<_Ty, bool>)
+    return scalar_kind::boolean;
+  else if constexpr (std::is_enum_v<_Ty>)
+    return get_scalar_kind<std::underlying_type_t<_Ty>>();
+  else if constexpr (std::is_integral_v<_Ty>)
+    return std::is_unsigned_v<_Ty> && sizeof(_Ty) >= sizeof(int64_t) ? scalar_kind::unsigned_integer : scalar_kind::integer;
+  else if constexpr (std::is_floating_point_v<_Ty>)
+    return scalar_kind::floating;
+  else
+    return scalar_kind::none;
+}
+
+template <typename _Ty>
+void to_scalar(_Ty _val, scalar &_out)
+{
+  constexpr auto kind = get_scalar_kind<_Ty>();
+  if constexpr (kind == scalar_kind::floating)
+    _out.d_ = (double)_val;
+  else if constexpr (kind == scalar_kind::unsigned_integer)
+    _out.u_ = (uint64_t)_val;
+  else
+    _out.i_ = (int64_t)_val;
+}
+
+constexpr size_t max_arg_cnt = 5;
+
+struct field_info;
+
+template <typename _Ty>
+const field_info *get_field_info();
+
 class fn_wrapper_base
 {
 public:
   virtual ~fn_wrapper_base() {}
+
+  // returns false if the arguments can't be passed, otherwise the summed conversion rank in _rank
+  virtual bool can_invoke(const type_desc *const *_descs, size_t _cnt, size_t &_rank) const = 0;
+
+  // layout of the returned type, nullptr for void
+  virtual const field_info *get_ret_info() const = 0;
+
+  // parameter types in declaration order, a member function's object comes first
+  virtual size_t get_arg_cnt() const = 0;
+  virtual const type_desc *const *get_arg_descs() const = 0;
+
+  // calls with a single argument and stores an arithmetic return in _val without going through a result,
+  // false if the function doesn't take one argument or doesn't return an arithmetic value
+  virtual bool invoke_scalar(void *_arg0, scalar &_val) = 0;
+
   virtual result operator()() = 0;
   virtual result operator()(argument _arg0) = 0;
   virtual result operator()(argument _arg0, argument _arg1) = 0;
@@ -372,6 +503,60 @@ class fn_wrapper : public fn_wrapper_base
 public:
   fn_wrapper(_Fn _fn) : fn_(_fn) {}
 
+  const field_info *get_ret_info() const override
+  {
+    using ret_t = typename fn_traits<_Fn>::ret_t;
+
+    if constexpr (std::is_void_v<ret_t>)
+      return nullptr;
+    else
+      return get_field_info<std::remove_reference_t<ret_t>>();
+  }
+
+  size_t get_arg_cnt() const override
+  {
+    return fn_traits<_Fn>::arg_cnt;
+  }
+
+  const type_desc *const *get_arg_descs() const override
+  {
+    return fn_traits<_Fn>::get_arg_descs().data();
+  }
+
+  bool can_invoke(const type_desc *const *_descs, size_t _cnt, size_t &_rank) const override
+  {
+    auto &descs = fn_traits<_Fn>::get_arg_descs();
+    if (_cnt != descs.size())
+      return false;
+
+    _rank = 0;
+    for (size_t i = 0; i < _cnt; ++i)
+    {
+      if (!_descs[i]->can_conv_to(*descs[i]))
+        return false;
+
+      _rank += _descs[i]->conv_rank(*descs[i]);
+    }
+
+    return true;
+  }
+
+  bool invoke_scalar(void *_arg0, scalar &_val) override
+  {
+    using traits_t = fn_traits<_Fn>;
+    using val_t = std::remove_cv_t<std::remove_reference_t<typename traits_t::ret_t>>;
+
+    if constexpr (traits_t::arg_cnt == 1 && get_scalar_kind<val_t>() != scalar_kind::none)
+    {
+      using arg_t = typename traits_t::template arg_t<0>;
+
+      to_scalar<val_t>(std::invoke(fn_, std::forward<arg_t>((std::add_lvalue_reference_t<arg_t>) * (std::remove_reference_t<arg_t> *)_arg0)), _val);
+      return true;
+    }
+    else
+      return false;
+  }
+
   result operator()() override
   {
     return fn_traits<_Fn>::invoke_fn(fn_, std::make_tuple());
@@ -406,184 +591,2350 @@ private:
   _Fn fn_;
 };
 
-struct method
+using symbol = uint32_t;
+
+constexpr symbol null_symbol = ~symbol(0);
+
+// process-wide pool of member names, each name is stored once in the arena,
+// names are interned at registration, lookups by name go through the per-type index instead
+class symbol_pool
 {
 public:
-  method() = default;
-  method(std::unique_ptr<fn_wrapper_base> _fn) : null_(false), fn_(std::move(_fn)) {}
-
-  bool is_null() const
+  static symbol_pool &instance()
   {
-    return null_;
+    // thread-safe
+    static symbol_pool pool;
+    return pool;
   }
 
-  template <typename... _Args>
-  result operator()(_Args &&... _args) const
+  symbol intern(std::string_view _name)
   {
-    assert(!null_);
-    return (*fn_.get())({ (void*)&_args, get_type_desc<_Args &&>() }...);
+    std::unique_lock lock(mtx_);
+
+    auto ite = syms_.find(_name);
+    if (ite != syms_.end())
+      return ite->second;
+
+    auto name = store(_name);
+    auto sym = (symbol)names_.size();
+    names_.push_back(name);
+    syms_.emplace(name, sym);
+
+    return sym;
   }
 
-private:
-  bool null_ = true;
-  std::unique_ptr<fn_wrapper_base> fn_ = nullptr;
-};
+  symbol find(std::string_view _name) const
+  {
+    std::shared_lock lock(mtx_);
 
-class obj_wrapper_base
-{
-public:
-  obj_wrapper_base() {}
-  virtual ~obj_wrapper_base() {}
-  virtual result operator()(argument _arg) = 0;
-};
+    auto ite = syms_.find(_name);
+    if (ite == syms_.end())
+      return null_symbol;
 
-template<typename _Cls, typename _Obj>
-class obj_wrapper : public obj_wrapper_base
-{
-public:
-  obj_wrapper(_Obj _Cls:: *_obj) : obj_(_obj) {}
+    return ite->second;
+  }
 
-  result operator()(argument _arg) override
+  std::string_view name(symbol _sym) const
   {
-    auto &desc = _arg.desc_;
-    assert(desc.can_conv_to(get_type_desc<_Cls>()));
+    std::shared_lock lock(mtx_);
+
+    assert(_sym < names_.size());
+    return names_[_sym];
+  }
 
-    auto &[con, vol] = desc.get_cv_qualifier();
-    auto &category = desc.get_val_category();
+private:
+  symbol_pool() = default;
 
-    if (con && vol)
+  std::string_view store(std::string_view _name)
+  {
+    // an oversized name gets a block of its own, the current block stays the last one
+    if (_name.size() > blk_sz)
     {
-      auto &v = *(volatile const _Cls *)_arg.ptr_;
-      return do_invoke(v, category);
+      auto blk = std::make_unique<char[]>(_name.size());
+      memcpy(blk.get(), _name.data(), _name.size());
+
+      std::string_view res{ blk.get(), _name.size() };
+      blks_.insert(blks_.empty() ? blks_.end() : blks_.end() - 1, std::move(blk));
+      return res;
     }
-    else if (con)
+
+    if (_name.size() > blk_sz - used_)
     {
-      auto &v = *(const _Cls *)_arg.ptr_;
-      return do_invoke(v, category);
+      blks_.push_back(std::make_unique<char[]>(blk_sz));
+      used_ = 0;
     }
-    else if (vol)
+
+    auto ptr = blks_.back().get() + used_;
+    memcpy(ptr, _name.data(), _name.size());
+    used_ += _name.size();
+
+    return { ptr, _name.size() };
+  }
+
+  static constexpr size_t blk_sz = 4096;
+
+  mutable std::shared_mutex mtx_;
+  std::vector<std::unique_ptr<char[]>> blks_;
+  size_t used_ = blk_sz;
+  std::vector<std::string_view> names_;
+  std::unordered_map<std::string_view, symbol> syms_;
+};
+
+// per-object set of changed property slots, opt in by adding a member and registering it with TR_DIRTY
+class dirty_set
+{
+public:
+  void mark(size_t _slot)
+  {
+    if (_slot < word_bits)
     {
-      auto &v = *(volatile _Cls *)_arg.ptr_;
-      return do_invoke(v, category);
+      bits_ |= uint64_t(1) << _slot;
+      return;
     }
-    else
+
+    auto idx = _slot / word_bits - 1;
+    if (idx >= more_.size())
+      more_.resize(idx + 1);
+
+    more_[idx] |= uint64_t(1) << (_slot % word_bits);
+  }
+
+  bool test(size_t _slot) const
+  {
+    if (_slot < word_bits)
+      return bits_ >> _slot & 1;
+
+    auto idx = _slot / word_bits - 1;
+    return idx < more_.size() && (more_[idx] >> (_slot % word_bits) & 1);
+  }
+
+  bool any() const
+  {
+    return bits_ || std::any_of(more_.begin(), more_.end(), [](uint64_t _w) { return _w != 0; });
+  }
+
+  void clear()
+  {
+    bits_ = 0;
+    std::fill(more_.begin(), more_.end(), 0);
+  }
+
+  // visits the marked slots in ascending order
+  template <typename _Fn>
+  void for_each(_Fn &&_fn) const
+  {
+    walk(bits_, 0, _fn);
+    for (size_t i = 0; i < more_.size(); ++i)
+      walk(more_[i], (i + 1) * word_bits, _fn);
+  }
+
+private:
+  static constexpr size_t word_bits = 64;
+
+  template <typename _Fn>
+  static void walk(uint64_t _w, size_t _base, _Fn &_fn)
+  {
+    while (_w)
     {
-      auto &v = *(_Cls *)_arg.ptr_;
-      return do_invoke(v, category);
+      _fn(_base + ctz(_w));
+      _w &= _w - 1;
     }
   }
 
-  template<typename _Ty>
-  result do_invoke(_Ty &&_v, const val_category &_category)
+  static size_t ctz(uint64_t _w)
   {
-    if (_category == val_category::lval)
-      return { std::invoke(obj_, _v) };
-    else
-      return { std::invoke(obj_, std::move(_v)) };
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward64(&idx, _w);
+    return idx;
+#else
+    return __builtin_ctzll(_w);
+#endif
   }
 
-private:
-  _Obj _Cls:: *obj_;
+  uint64_t bits_ = 0;
+  std::vector<uint64_t> more_;
 };
 
-class property
+using dirty_fn = dirty_set *(*)(void *);
+
+struct method
 {
 public:
-  property() = default;
-  property(std::unique_ptr<obj_wrapper_base> _obj) : null_(false), obj_(std::move(_obj)) {}
+  method() = default;
+  method(symbol _sym, std::unique_ptr<fn_wrapper_base> _fn) : null_(false), sym_(_sym)
+  {
+    fns_.push_back(std::move(_fn));
+  }
 
   bool is_null() const
   {
     return null_;
   }
 
-  template <typename _Obj, typename _Ty>
-  _Obj get(_Ty &&_arg) const
+  symbol get_symbol() const
+  {
+    return sym_;
+  }
+
+  size_t get_overload_cnt() const
+  {
+    return fns_.size();
+  }
+
+  // the overload a call with these argument types would take, nullptr if there's none
+  fn_wrapper_base *find_overload(const type_desc *const *_descs, size_t _cnt) const
   {
     assert(!null_);
-    return (*obj_.get())({ (void*)&_arg, get_type_desc<_Ty &&>() }).template get<_Obj>();
+
+    if (fns_.size() > 1)
+      return resolve(_descs, _cnt);
+
+    size_t rank = 0;
+    return fns_.front()->can_invoke(_descs, _cnt, rank) ? fns_.front().get() : nullptr;
   }
 
-  template <typename _Obj, typename _Ty>
-  void set(_Ty &&_arg, _Obj &&_obj) const
+  void add_overload(std::unique_ptr<fn_wrapper_base> _fn)
   {
     assert(!null_);
 
-    auto &&res = (*obj_.get())({ (void *)& _arg, get_type_desc<_Ty &&>() });
-    res.template get<std::add_lvalue_reference_t<remove_cvref_t<_Obj>>>() = std::forward<_Obj>(_obj);
+    // the same signature registered twice would never be picked
+    assert(std::none_of(fns_.begin(), fns_.end(), [&](const std::unique_ptr<fn_wrapper_base> &_other) {
+      auto cnt = _fn->get_arg_cnt();
+      return _other->get_arg_cnt() == cnt && std::equal(_fn->get_arg_descs(), _fn->get_arg_descs() + cnt, _other->get_arg_descs());
+    }));
+
+    if (!cache_)
+      cache_ = std::make_unique<overload_cache>();
+
+    fns_.push_back(std::move(_fn));
+  }
+
+  template <typename... _Args>
+  result operator()(_Args &&... _args) const
+  {
+    static_assert(sizeof...(_Args) <= max_arg_cnt);
+    assert(!null_);
+
+    auto fn = fns_.front().get();
+    if (fns_.size() > 1)
+    {
+      std::array<const type_desc *, sizeof...(_Args)> descs = { &get_type_desc<_Args &&>()... };
+      fn = resolve(descs.data(), descs.size());
+      if (!fn)
+      {
+        // no viable overload
+        assert(false);
+        return result();
+      }
+    }
+
+    auto res = (*fn)({ (void*)&_args, get_type_desc<_Args &&>() }...);
+
+    // a setter marks its property in the object, the first argument
+    if constexpr (sizeof...(_Args) > 0)
+    {
+      if (dirty_)
+      {
+        void *objs[] = { (void *)&_args... };
+        dirty_(objs[0])->mark(dirty_slot_);
+      }
+    }
+
+    return res;
+  }
+
+  // calls mark _slot in the object's dirty_set, see TR_SETTER
+  void track_dirty(dirty_fn _dirty, size_t _slot)
+  {
+    dirty_ = _dirty;
+    dirty_slot_ = _slot;
   }
 
 private:
+  // a hit is a few atomic loads, entries are immutable once published and live as long as the method,
+  // so a reader never sees one half written or freed
+  struct overload_cache
+  {
+    static constexpr size_t entry_cnt = 4;
+
+    struct entry
+    {
+      size_t cnt_ = 0;
+      std::array<const type_desc *, max_arg_cnt> descs_ = {};
+      fn_wrapper_base *fn_ = nullptr;
+
+      bool match(const type_desc *const *_descs, size_t _cnt) const
+      {
+        return cnt_ == _cnt && std::equal(_descs, _descs + _cnt, descs_.begin());
+      }
+    };
+
+    std::array<std::atomic<const entry *>, entry_cnt> slots_ = {};
+
+    // every entry ever resolved, one per distinct argument list, guarded by mtx_
+    std::mutex mtx_;
+    std::vector<std::unique_ptr<entry>> entries_;
+    size_t next_ = 0;
+  };
+
+  fn_wrapper_base *resolve(const type_desc *const *_descs, size_t _cnt) const
+  {
+    for (auto &slot : cache_->slots_)
+    {
+      auto e = slot.load(std::memory_order_acquire);
+      if (e && e->match(_descs, _cnt))
+        return e->fn_;
+    }
+
+    std::unique_lock lock(cache_->mtx_);
+
+    // an argument list resolved before and evicted since is published again without resolving
+    const overload_cache::entry *hit = nullptr;
+    for (auto &e : cache_->entries_)
+    {
+      if (e->match(_descs, _cnt))
+      {
+        hit = e.get();
+        break;
+      }
+    }
+
+    if (!hit)
+    {
+      // pick the viable overload with the lowest conversion rank, the first registered one wins a tie
+      fn_wrapper_base *best = nullptr;
+      size_t best_rank = 0;
+      for (auto &fn : fns_)
+      {
+        size_t rank = 0;
+        if (fn->can_invoke(_descs, _cnt, rank) && (!best || rank < best_rank))
+        {
+          best = fn.get();
+          best_rank = rank;
+        }
+      }
+
+      if (!best)
+        return nullptr;
+
+      auto e = std::make_unique<overload_cache::entry>();
+      e->cnt_ = _cnt;
+      std::copy(_descs, _descs + _cnt, e->descs_.begin());
+      e->fn_ = best;
+
+      hit = e.get();
+      cache_->entries_.push_back(std::move(e));
+    }
+
+    cache_->slots_[cache_->next_++ % overload_cache::entry_cnt].store(hit, std::memory_order_release);
+    return hit->fn_;
+  }
+
   bool null_ = true;
-  std::unique_ptr<obj_wrapper_base> obj_ = nullptr;
+  symbol sym_ = null_symbol;
+  dirty_fn dirty_ = nullptr;
+  size_t dirty_slot_ = 0;
+  std::vector<std::unique_ptr<fn_wrapper_base>> fns_;
+  std::unique_ptr<overload_cache> cache_;
 };
 
 template <typename _Cls>
-class tr_info
+class tr_info;
+
+template <typename _Cls>
+const tr_info<_Cls> &get_tr_info();
+
+class property;
+
+inline uint64_t hash_mix(uint64_t _h)
 {
-public:
-  tr_info() { init(); }
+  _h ^= _h >> 33;
+  _h *= 0xff51afd7ed558ccdull;
+  _h ^= _h >> 33;
+  _h *= 0xc4ceb9fe1a85ec53ull;
+  _h ^= _h >> 33;
+  return _h;
+}
 
-  void init() {}
+// four independent lanes of 8 bytes each, so the main loop pipelines and vectorizes
+inline uint64_t hash_bytes(const void *_data, size_t _len, uint64_t _seed)
+{
+  constexpr uint64_t k0 = 0x9e3779b97f4a7c15ull, k1 = 0xbf58476d1ce4e5b9ull;
 
-  template<typename _Fn, typename = std::enable_if_t<std::is_function_v<_Fn>>>
-  void add_method(const std::string & _name, _Fn _Cls:: * _fn)
-  {
-    assert(_fn && methods_.find(_name) == methods_.end());
+  auto p = (const uint8_t *)_data;
+  uint64_t lanes[4] = { _seed ^ k0, _seed ^ k1, _seed + k0, _seed - k1 };
 
-    method_names_.push_back(_name);
-    methods_[_name] = { std::make_unique<fn_wrapper<_Fn _Cls:: *>>(_fn) };
+  for (; _len >= 32; _len -= 32, p += 32)
+  {
+    uint64_t w[4];
+    memcpy(w, p, 32);
+    for (size_t i = 0; i < 4; ++i)
+      lanes[i] = (lanes[i] ^ w[i]) * k1 + (lanes[i] >> 29);
   }
 
-  template<typename _Obj, typename = std::enable_if_t<std::is_object_v<_Obj>>>
-  void add_property(const std::string & _name, _Obj _Cls:: * _obj)
+  uint64_t h = lanes[0] ^ (lanes[1] * k0) ^ (lanes[2] >> 17) ^ (lanes[3] * k1);
+  for (; _len >= 8; _len -= 8, p += 8)
   {
-    assert(_obj && properties_.find(_name) == properties_.end());
-
-    property_names_.push_back(_name);
-    properties_[_name] = { std::make_unique<obj_wrapper<_Cls, _Obj>>(_obj) };
+    uint64_t w;
+    memcpy(&w, p, 8);
+    h = (h ^ w) * k1 + (h >> 31);
   }
 
-  const std::vector<std::string> get_method_names() const { return method_names_; }
-
-  const std::vector<std::string> get_property_names() const { return property_names_; }
+  uint64_t tail = 0;
+  memcpy(&tail, p, _len);
+  return hash_mix(h ^ tail ^ (uint64_t(_len) << 56));
+}
 
-  const method &get_method(const std::string & _name) const
+// LEB128, 7 bits per byte with the high bit set on all but the last
+inline void put_varint(std::vector<uint8_t> &_out, size_t _v)
+{
+  while (_v >= 0x80)
   {
-    auto ite = methods_.find(_name);
-    if (ite == methods_.end())
-      return null_method_;
-
-    return ite->second;
+    _out.push_back(uint8_t(_v | 0x80));
+    _v >>= 7;
   }
 
-  const property &get_property(const std::string & _name) const
-  {
-    auto ite = properties_.find(_name);
-    if (ite == properties_.end())
-      return null_property_;
+  _out.push_back(uint8_t(_v));
+}
 
-    return ite->second;
+// false on a truncated or overlong varint, _p is advanced past it otherwise
+inline bool get_varint(const uint8_t *&_p, const uint8_t *_end, size_t &_v)
+{
+  _v = 0;
+  for (size_t shift = 0; _p < _end && shift < sizeof(size_t) * 8; shift += 7)
+  {
+    auto b = *_p++;
+    _v |= size_t(b & 0x7f) << shift;
+    if (!(b & 0x80))
+      return true;
   }
 
-private:
-  std::vector<std::string> method_names_;
-  std::vector<std::string> property_names_;
+  return false;
+}
 
-  std::map<std::string, method> methods_;
-  std::map<std::string, property> properties_;
+template <typename _Ty, typename = void>
+struct is_std_hashable : std::false_type
+{};
 
-  static inline method null_method_;
-  static inline property null_property_;
+template <typename _Ty>
+struct is_std_hashable<_Ty, std::enable_if_t<std::is_default_constructible_v<std::hash<_Ty>>>> : std::true_type
+{};
+
+template <typename _Ty, typename = void>
+struct is_random_access_container : std::false_type
+{};
+
+template <typename _Ty>
+struct is_random_access_container<_Ty, std::enable_if_t<std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<typename _Ty::iterator>::iterator_category>>> : std::true_type
+{};
+
+// operator[] gives a real reference to an element, which rules out proxies such as std::vector<bool>
+template <typename _Ty, typename = void>
+struct is_indexable_container : std::false_type
+{};
+
+template <typename _Ty>
+struct is_indexable_container<_Ty, std::enable_if_t<is_random_access_container<std::remove_cv_t<_Ty>>::value
+  && std::is_lvalue_reference_v<decltype(std::declval<_Ty &>()[0])>>> : std::true_type
+{};
+
+template <typename _Ty, typename = void>
+struct is_equality_comparable : std::false_type
+{};
+
+// a container's operator== isn't constrained on its elements, so they are checked too
+template <typename _Ty, typename = void>
+struct is_elem_equality_comparable : std::true_type
+{};
+
+template <typename _Ty>
+struct is_elem_equality_comparable<_Ty, std::void_t<typename _Ty::value_type>> : is_equality_comparable<typename _Ty::value_type>
+{};
+
+template <typename _Ty>
+struct is_equality_comparable<_Ty, std::enable_if_t<!std::is_array_v<_Ty>, std::void_t<decltype(std::declval<const _Ty &>() == std::declval<const _Ty &>())>>> : is_elem_equality_comparable<_Ty>
+{};
+
+// equal values have equal bytes and equal bytes mean equal values, so memcmp and hashing the bytes are valid:
+// scalars without padding and arrays of them. float and double compare by bit pattern, so -0.0 and 0.0 differ
+// and a NaN equals itself. classes never are, a nested reflected type compares through its registered fields
+template <typename _Ty>
+struct is_bitwise : std::bool_constant<std::is_scalar_v<_Ty> && (std::has_unique_object_representations_v<_Ty>
+  || (std::is_floating_point_v<_Ty> && (sizeof(_Ty) == sizeof(float) || sizeof(_Ty) == sizeof(double))))>
+{};
+
+template <typename _Ty, size_t _Cnt>
+struct is_bitwise<_Ty[_Cnt]> : is_bitwise<_Ty>
+{};
+
+// any bytes read off the wire are a valid value and none is an address: integers other than bool,
+// float and double, and arrays of them. padded, pointer, bool and enum values need a checked codec
+template <typename _Ty>
+struct is_raw_wire : std::bool_constant<(std::is_integral_v<_Ty> && !std::is_same_v<_Ty, bool>)
+  || (std::is_floating_point_v<_Ty> && (sizeof(_Ty) == sizeof(float) || sizeof(_Ty) == sizeof(double)))>
+{};
+
+template <typename _Ty, size_t _Cnt>
+struct is_raw_wire<_Ty[_Cnt]> : is_raw_wire<_Ty>
+{};
+
+// values of an enum accepted from the wire, the whole underlying range by default,
+// specialize it to reject values outside the enumerators, e.g.
+//   template <> struct enum_range<color> { static constexpr int64_t min_ = 0, max_ = 2; };
+template <typename _Ty>
+struct enum_range
+{
+  using under_t = std::underlying_type_t<_Ty>;
+
+  static constexpr std::conditional_t<std::is_signed_v<under_t>, int64_t, uint64_t> min_ = std::numeric_limits<under_t>::min();
+  static constexpr std::conditional_t<std::is_signed_v<under_t>, int64_t, uint64_t> max_ = std::numeric_limits<under_t>::max();
+};
+
+template <typename _Ty, typename = void>
+struct is_unordered_container : std::false_type
+{};
+
+template <typename _Ty>
+struct is_unordered_container<_Ty, std::void_t<typename _Ty::hasher>> : std::true_type
+{};
+
+template <typename _Ty, typename = void>
+struct is_container : std::false_type
+{};
+
+template <typename _Ty>
+struct is_container<_Ty, std::void_t<typename _Ty::value_type, decltype(std::declval<_Ty &>().begin()), decltype(std::declval<_Ty &>().end()), decltype(std::declval<const _Ty &>().size())>> : std::true_type
+{};
+
+template <typename _Ty, typename = void>
+struct is_contiguous_container : std::false_type
+{};
+
+template <typename _Ty>
+struct is_contiguous_container<_Ty, std::enable_if_t<std::is_same_v<decltype(std::declval<_Ty &>().data()), typename _Ty::value_type *>>> : std::true_type
+{};
+
+template <typename _Ty, typename = void>
+struct is_resizable_container : std::false_type
+{};
+
+template <typename _Ty>
+struct is_resizable_container<_Ty, std::void_t<decltype(std::declval<_Ty &>().resize(size_t()))>> : std::true_type
+{};
+
+// insert(end(), first, last) from a pointer range, sequences
+template <typename _Ty, typename = void>
+struct is_range_appendable_container : std::false_type
+{};
+
+template <typename _Ty>
+struct is_range_appendable_container<_Ty, std::void_t<decltype(std::declval<_Ty &>().insert(std::declval<_Ty &>().end(),
+  std::declval<const typename _Ty::value_type *>(), std::declval<const typename _Ty::value_type *>()))>> : std::true_type
+{};
+
+// insert(first, last) from a pointer range, sets
+template <typename _Ty, typename = void>
+struct is_range_insertable_container : std::false_type
+{};
+
+template <typename _Ty>
+struct is_range_insertable_container<_Ty, std::void_t<decltype(std::declval<_Ty &>().insert(std::declval<const typename _Ty::value_type *>(), std::declval<const typename _Ty::value_type *>()))>> : std::true_type
+{};
+
+// insert(end(), value), sequences append and sets take end() as a hint
+template <typename _Ty, typename = void>
+struct is_insertable_container : std::false_type
+{};
+
+template <typename _Ty>
+struct is_insertable_container<_Ty, std::void_t<decltype(std::declval<_Ty &>().insert(std::declval<_Ty &>().end(), std::declval<typename _Ty::value_type &&>()))>> : std::true_type
+{};
+
+// type-erased operations on a standard container, the unsupported ones are nullptr
+struct container_ops
+{
+  using visit_fn = void (*)(void *, const void *);
+
+  const type_desc *elem_desc_ = nullptr;
+  size_t elem_size_ = 0;
+
+  size_t (*size_)(const void *) = nullptr;
+  void *(*data_)(void *) = nullptr;
+  void (*for_each_)(const void *, visit_fn, void *) = nullptr;
+  void (*resize_)(void *, size_t) = nullptr;
+  void (*append_)(void *, const void *, size_t) = nullptr;
+
+  template <typename _Ty>
+  static const container_ops *of()
+  {
+    using elem_t = typename _Ty::value_type;
+
+    // thread-safe
+    static const container_ops ops = []() {
+      container_ops res;
+      res.elem_desc_ = &get_type_desc<elem_t>();
+      res.elem_size_ = sizeof(elem_t);
+
+      res.size_ = [](const void *_obj) { return (size_t)((const _Ty *)_obj)->size(); };
+
+      res.for_each_ = [](const void *_obj, visit_fn _fn, void *_ctx) {
+        for (const auto &e : *(const _Ty *)_obj)
+          _fn(_ctx, &e);
+      };
+
+      if constexpr (is_contiguous_container<_Ty>::value)
+        res.data_ = [](void *_obj) { return (void *)((_Ty *)_obj)->data(); };
+
+      // the members are declared for any element type, only their bodies need it to be constructible
+      if constexpr (is_resizable_container<_Ty>::value && std::is_default_constructible_v<elem_t>)
+        res.resize_ = [](void *_obj, size_t _cnt) { ((_Ty *)_obj)->resize(_cnt); };
+
+      // a sequence may shift elements on insert, so they have to be assignable too
+      if constexpr (is_range_appendable_container<_Ty>::value && std::is_copy_constructible_v<elem_t> && std::is_move_assignable_v<elem_t>)
+      {
+        res.append_ = [](void *_obj, const void *_elems, size_t _cnt) {
+          auto &c = *(_Ty *)_obj;
+          auto p = (const elem_t *)_elems;
+          c.insert(c.end(), p, p + _cnt);
+        };
+      }
+      else if constexpr (is_range_insertable_container<_Ty>::value && std::is_copy_constructible_v<elem_t>)
+      {
+        res.append_ = [](void *_obj, const void *_elems, size_t _cnt) {
+          auto p = (const elem_t *)_elems;
+          ((_Ty *)_obj)->insert(p, p + _cnt);
+        };
+      }
+
+      return res;
+    }();
+
+    return &ops;
+  }
+};
+
+struct method;
+
+// storage layout of a property and type-erased value operations on it
+struct field_info
+{
+  bool member_ = false;
+  // owner of a member
+  const type_desc *cls_ = nullptr;
+  size_t offset_ = 0;
+  size_t size_ = 0;
+
+  // trivially copyable, copied as raw bytes
+  bool trivial_ = false;
+  // compared and hashed as raw bytes, see is_bitwise
+  bool bitwise_ = false;
+  // sent and received as raw bytes, see is_raw_wire
+  bool raw_wire_ = false;
+  bool writable_ = false;
+
+  // the field as an lvalue, with its own cv qualifiers
+  const type_desc *desc_ = nullptr;
+
+  // an equivalence and a hash consistent with it, nullptr if the values can't be compared or hashed,
+  // reflect_equal and reflect_hash skip such fields and diff always sends them
+  bool (*equal_)(const void *, const void *) = nullptr;
+  size_t (*hash_)(const void *) = nullptr;
+  // set for a class without operator== or a unique representation, it only compares when it is reflected
+  bool (*reflected_)() = nullptr;
+  std::shared_ptr<void> (*clone_)(const void *) = nullptr;
+  void (*assign_)(void *, const void *) = nullptr;
+
+  // wire format of the value, see patch::encode, both return false if a part of the value has no codec
+  // and decode_ also on malformed input
+  bool (*encode_)(const void *, std::vector<uint8_t> &) = nullptr;
+  bool (*decode_)(void *, const uint8_t *&, const uint8_t *) = nullptr;
+
+  // property and method of a nested reflected type by name, nullptr if there's none
+  const property *(*child_)(std::string_view) = nullptr;
+  const method *(*child_method_)(std::string_view) = nullptr;
+
+  // set for arithmetic types, reads the value into a scalar
+  scalar_kind scalar_ = scalar_kind::none;
+  void (*load_scalar_)(const void *, scalar &) = nullptr;
+
+  // indexing, a built-in array has a fixed stride, a random access container goes through elem_,
+  // which gives nullptr for an index out of range
+  size_t elem_cnt_ = 0;
+  size_t elem_size_ = 0;
+  void *(*elem_)(void *, size_t) = nullptr;
+  const field_info *(*elem_info_)() = nullptr;
+
+  // set for standard containers, see container_view
+  const container_ops *container_ = nullptr;
+
+  // address of a static member or global
+  void *addr_ = nullptr;
+
+  template <typename _Obj>
+  static const field_info &of()
+  {
+    // thread-safe
+    static field_info info = make<_Obj>();
+    return info;
+  }
+
+  template <typename _Obj>
+  static field_info make()
+  {
+    using val_t = std::remove_cv_t<_Obj>;
+
+    field_info info;
+    info.size_ = sizeof(val_t);
+    info.trivial_ = std::is_trivially_copyable_v<val_t>;
+    info.bitwise_ = is_bitwise<val_t>::value;
+    info.raw_wire_ = is_raw_wire<val_t>::value;
+    info.writable_ = !std::is_const_v<_Obj> && (std::is_copy_assignable_v<val_t> || info.trivial_);
+    info.desc_ = &get_type_desc<_Obj &>();
+
+    if constexpr (std::is_array_v<val_t>)
+    {
+      using elem_t = std::remove_extent_t<_Obj>;
+      info.elem_cnt_ = std::extent_v<val_t>;
+      info.elem_size_ = sizeof(elem_t);
+      info.elem_info_ = []() { return &of<elem_t>(); };
+    }
+    else if constexpr (is_indexable_container<_Obj>::value)
+    {
+      using elem_t = std::remove_reference_t<decltype(std::declval<_Obj &>()[0])>;
+      info.elem_ = [](void *_obj, size_t _idx) {
+        auto &c = *(_Obj *)_obj;
+        return _idx < c.size() ? (void *)&c[_idx] : nullptr;
+      };
+      info.elem_info_ = []() { return &of<elem_t>(); };
+    }
+    else if constexpr (std::is_class_v<val_t> && !is_container<val_t>::value)
+    {
+      info.child_ = [](std::string_view _name) { return &get_tr_info<val_t>().get_property(_name); };
+      info.child_method_ = [](std::string_view _name) { return &get_tr_info<val_t>().get_method(_name); };
+    }
+
+    if constexpr (get_scalar_kind<val_t>() != scalar_kind::none)
+    {
+      // only a volatile member is read through a volatile pointer
+      using load_t = std::conditional_t<std::is_volatile_v<_Obj>, const volatile val_t, const val_t>;
+
+      info.scalar_ = get_scalar_kind<val_t>();
+      info.load_scalar_ = [](const void *_obj, scalar &_val) { to_scalar<val_t>(*(load_t *)_obj, _val); };
+    }
+
+    if constexpr (is_container<val_t>::value)
+      info.container_ = container_ops::of<val_t>();
+
+    if constexpr (is_bitwise<val_t>::value)
+    {
+      info.equal_ = [](const void *_a, const void *_b) { return memcmp(_a, _b, sizeof(val_t)) == 0; };
+      info.hash_ = [](const void *_obj) { return (size_t)hash_bytes(_obj, sizeof(val_t), 0); };
+    }
+    else if constexpr (std::is_floating_point_v<val_t>)
+    {
+      // padded, e.g. the x87 long double, by value with the sign of zero and all NaNs equal, like the bit pattern
+      info.equal_ = [](const void *_a, const void *_b) {
+        auto a = *(const val_t *)_a, b = *(const val_t *)_b;
+        return (a == b && std::signbit(a) == std::signbit(b)) || (std::isnan(a) && std::isnan(b));
+      };
+
+      info.hash_ = [](const void *_obj) {
+        auto v = *(const val_t *)_obj;
+        return std::isnan(v) ? ~size_t(0) : std::hash<val_t>()(v) ^ (size_t)std::signbit(v);
+      };
+    }
+    else if constexpr (std::is_array_v<val_t> || (is_container<val_t>::value && !is_unordered_container<val_t>::value
+      && !(is_std_hashable<val_t>::value && is_equality_comparable<val_t>::value)))
+    {
+      // element by element in iteration order
+      using elem_t = remove_cvref_t<decltype(*std::begin(std::declval<const val_t &>()))>;
+
+      if (of<elem_t>().equal_)
+      {
+        info.equal_ = [](const void *_a, const void *_b) {
+          auto &a = *(const val_t *)_a, &b = *(const val_t *)_b;
+          auto &e = of<elem_t>();
+          return std::equal(std::begin(a), std::end(a), std::begin(b), std::end(b), [&](const elem_t &_x, const elem_t &_y) { return e.equal_(&_x, &_y); });
+        };
+      }
+
+      if (of<elem_t>().hash_)
+      {
+        info.hash_ = [](const void *_obj) {
+          auto &e = of<elem_t>();
+
+          uint64_t h = std::size(*(const val_t *)_obj);
+          for (const elem_t &v : *(const val_t *)_obj)
+            h = hash_mix(h ^ e.hash_(&v));
+
+          return (size_t)h;
+        };
+      }
+    }
+    else if constexpr (is_unordered_container<val_t>::value)
+    {
+      // the container's own key equality and hasher, the element hashes are summed so the order doesn't matter
+      if constexpr (is_equality_comparable<val_t>::value)
+      {
+        info.equal_ = [](const void *_a, const void *_b) { return *(const val_t *)_a == *(const val_t *)_b; };
+
+        info.hash_ = [](const void *_obj) {
+          auto &c = *(const val_t *)_obj;
+
+          uint64_t h = 0;
+          for (auto &v : c)
+          {
+            if constexpr (std::is_same_v<typename val_t::key_type, typename val_t::value_type>)
+              h += hash_mix(c.hash_function()(v));
+            else
+              h += hash_mix(c.hash_function()(v.first));
+          }
+
+          return (size_t)hash_mix(h ^ c.size());
+        };
+      }
+    }
+    else if constexpr (is_container<val_t>::value)
+    {
+      // strings and the like, their operator== and std::hash agree
+      info.equal_ = [](const void *_a, const void *_b) { return *(const val_t *)_a == *(const val_t *)_b; };
+      info.hash_ = [](const void *_obj) { return std::hash<val_t>()(*(const val_t *)_obj); };
+    }
+    else if constexpr (std::is_class_v<val_t>)
+    {
+      // a nested reflected type compares through its registered fields, which is decided on the first call
+      // so registering this type doesn't register the nested one
+      constexpr bool unique = std::is_trivially_copyable_v<val_t> && std::has_unique_object_representations_v<val_t>;
+
+      info.equal_ = [](const void *_a, const void *_b) {
+        auto &a = *(const val_t *)_a, &b = *(const val_t *)_b;
+
+        auto &t = get_tr_info<val_t>();
+        if (t.is_reflected())
+          return t.equal(a, b);
+
+        if constexpr (is_equality_comparable<val_t>::value)
+          return a == b;
+        else if constexpr (unique)
+          return memcmp(_a, _b, sizeof(val_t)) == 0;
+        else
+          return true;
+      };
+
+      info.hash_ = [](const void *_obj) {
+        auto &obj = *(const val_t *)_obj;
+
+        auto &t = get_tr_info<val_t>();
+        if (t.is_reflected())
+          return t.hash(obj);
+
+        if constexpr (is_std_hashable<val_t>::value && is_equality_comparable<val_t>::value)
+          return std::hash<val_t>()(obj);
+        else if constexpr (unique && !is_equality_comparable<val_t>::value)
+          return (size_t)hash_bytes(_obj, sizeof(val_t), 0);
+        else
+          return size_t(0);
+      };
+
+      if constexpr (!is_equality_comparable<val_t>::value && !unique)
+        info.reflected_ = []() { return get_tr_info<val_t>().is_reflected(); };
+    }
+    else if constexpr (is_equality_comparable<val_t>::value)
+    {
+      info.equal_ = [](const void *_a, const void *_b) { return *(const val_t *)_a == *(const val_t *)_b; };
+
+      if constexpr (is_std_hashable<val_t>::value)
+        info.hash_ = [](const void *_obj) { return std::hash<val_t>()(*(const val_t *)_obj); };
+    }
+
+    // raw bytes for is_raw_wire values, one checked byte for bool, the underlying value for enums,
+    // a count and the elements for containers and arrays, the registered writable fields for reflected classes,
+    // pointers have no codec so an address never crosses the wire
+    if constexpr (is_raw_wire<val_t>::value)
+    {
+      info.encode_ = [](const void *_obj, std::vector<uint8_t> &_out) {
+        auto p = (const uint8_t *)_obj;
+        _out.insert(_out.end(), p, p + sizeof(val_t));
+        return true;
+      };
+
+      if constexpr (!std::is_const_v<_Obj>)
+      {
+        info.decode_ = [](void *_obj, const uint8_t *&_p, const uint8_t *_end) {
+          if (size_t(_end - _p) < sizeof(val_t))
+            return false;
+
+          memcpy(_obj, _p, sizeof(val_t));
+          _p += sizeof(val_t);
+          return true;
+        };
+      }
+    }
+    else if constexpr (std::is_same_v<val_t, bool>)
+    {
+      info.encode_ = [](const void *_obj, std::vector<uint8_t> &_out) {
+        _out.push_back(*(const bool *)_obj ? 1 : 0);
+        return true;
+      };
+
+      if constexpr (!std::is_const_v<_Obj>)
+      {
+        info.decode_ = [](void *_obj, const uint8_t *&_p, const uint8_t *_end) {
+          if (_p == _end || *_p > 1)
+            return false;
+
+          *(bool *)_obj = *_p++ != 0;
+          return true;
+        };
+      }
+    }
+    else if constexpr (std::is_enum_v<val_t>)
+    {
+      using under_t = std::underlying_type_t<val_t>;
+
+      info.encode_ = [](const void *_obj, std::vector<uint8_t> &_out) {
+        auto v = (under_t)*(const val_t *)_obj;
+        return of<under_t>().encode_(&v, _out);
+      };
+
+      if constexpr (!std::is_const_v<_Obj>)
+      {
+        info.decode_ = [](void *_obj, const uint8_t *&_p, const uint8_t *_end) {
+          under_t v{};
+          if (!of<under_t>().decode_(&v, _p, _end) || v < enum_range<val_t>::min_ || v > enum_range<val_t>::max_)
+            return false;
+
+          *(val_t *)_obj = (val_t)v;
+          return true;
+        };
+      }
+    }
+    else if constexpr (std::is_array_v<val_t>)
+    {
+      using elem_t = std::remove_extent_t<_Obj>;
+
+      info.encode_ = [](const void *_obj, std::vector<uint8_t> &_out) {
+        auto &e = of<elem_t>();
+        for (const auto &v : *(const val_t *)_obj)
+        {
+          if (!e.encode_ || !e.encode_(&v, _out))
+            return false;
+        }
+
+        return true;
+      };
+
+      if constexpr (!std::is_const_v<_Obj>)
+      {
+        info.decode_ = [](void *_obj, const uint8_t *&_p, const uint8_t *_end) {
+          auto &e = of<elem_t>();
+          for (auto &v : *(val_t *)_obj)
+          {
+            if (!e.decode_ || !e.decode_(&v, _p, _end))
+              return false;
+          }
+
+          return true;
+        };
+      }
+    }
+    else if constexpr (is_container<val_t>::value)
+    {
+      using elem_t = typename val_t::value_type;
+
+      info.encode_ = [](const void *_obj, std::vector<uint8_t> &_out) {
+        auto &c = *(const val_t *)_obj;
+        put_varint(_out, c.size());
+
+        auto &e = of<elem_t>();
+        for (const auto &v : c)
+        {
+          if (!e.encode_ || !e.encode_(&v, _out))
+            return false;
+        }
+
+        return true;
+      };
+
+      constexpr bool trivial_elems = !std::is_const_v<_Obj> && is_raw_wire<std::remove_cv_t<elem_t>>::value && is_contiguous_container<val_t>::value
+        && is_resizable_container<val_t>::value && std::is_default_constructible_v<elem_t>;
+
+      if constexpr (trivial_elems)
+      {
+        info.decode_ = [](void *_obj, const uint8_t *&_p, const uint8_t *_end) {
+          size_t cnt = 0;
+          if (!get_varint(_p, _end, cnt) || cnt > size_t(_end - _p) / sizeof(elem_t))
+            return false;
+
+          auto &c = *(val_t *)_obj;
+          c.resize(cnt);
+          if (cnt)
+            memcpy((void *)c.data(), _p, cnt * sizeof(elem_t));
+
+          _p += cnt * sizeof(elem_t);
+          return true;
+        };
+      }
+      else if constexpr (!std::is_const_v<_Obj> && std::is_default_constructible_v<remove_cvref_t<elem_t>> && is_insertable_container<val_t>::value)
+      {
+        info.decode_ = [](void *_obj, const uint8_t *&_p, const uint8_t *_end) {
+          // every element takes at least one byte, which bounds the count before anything is allocated
+          size_t cnt = 0;
+          if (!get_varint(_p, _end, cnt) || cnt > size_t(_end - _p))
+            return false;
+
+          auto &c = *(val_t *)_obj;
+          auto &e = of<elem_t>();
+          if (!e.decode_)
+            return false;
+
+          c.clear();
+          for (size_t i = 0; i < cnt; ++i)
+          {
+            remove_cvref_t<elem_t> v{};
+            if (!e.decode_(&v, _p, _end))
+              return false;
+
+            c.insert(c.end(), std::move(v));
+          }
+
+          return true;
+        };
+      }
+    }
+    else if constexpr (std::is_class_v<val_t>)
+    {
+      info.encode_ = [](const void *_obj, std::vector<uint8_t> &_out) {
+        return get_tr_info<val_t>().encode(*(const val_t *)_obj, _out);
+      };
+
+      if constexpr (!std::is_const_v<_Obj>)
+      {
+        info.decode_ = [](void *_obj, const uint8_t *&_p, const uint8_t *_end) {
+          return get_tr_info<val_t>().decode(*(val_t *)_obj, _p, _end);
+        };
+      }
+    }
+
+    if constexpr (std::is_copy_constructible_v<val_t>)
+      info.clone_ = [](const void *_obj) -> std::shared_ptr<void> { return std::make_shared<val_t>(*(const val_t *)_obj); };
+
+    if constexpr (std::is_copy_assignable_v<val_t>)
+      info.assign_ = [](void *_dest, const void *_src) { *(val_t *)_dest = *(const val_t *)_src; };
+    else if constexpr (std::is_trivially_copyable_v<val_t>)
+      info.assign_ = [](void *_dest, const void *_src) { memcpy(_dest, _src, sizeof(val_t)); };
+
+    return info;
+  }
+};
+
+template <typename _Ty>
+const field_info *get_field_info()
+{
+  return &field_info::of<_Ty>();
+}
+
+class obj_wrapper_base
+{
+public:
+  obj_wrapper_base() {}
+  virtual ~obj_wrapper_base() {}
+  virtual result operator()(argument _arg) = 0;
+
+  const field_info &get_field() const
+  {
+    return field_;
+  }
+
+  // access without an object, only static members and globals support it
+  virtual result operator()()
+  {
+    assert(false);
+    return result();
+  }
+
+protected:
+  field_info field_;
+};
+
+template<typename _Cls, typename _Obj>
+class obj_wrapper : public obj_wrapper_base
+{
+public:
+  obj_wrapper(_Obj _Cls:: *_obj) : obj_(_obj)
+  {
+    // the object is never constructed, only its address is used
+    std::aligned_storage_t<sizeof(_Cls), alignof(_Cls)> storage;
+    auto base = (const char *)&storage;
+
+    field_ = field_info::make<_Obj>();
+    field_.member_ = true;
+    field_.cls_ = &get_type_desc<_Cls>();
+    field_.offset_ = (const char *)&(((const _Cls *)base)->*_obj) - base;
+  }
+
+  result operator()(argument _arg) override
+  {
+    assert(_arg.desc_.can_conv_to(get_type_desc<_Cls>()));
+    return thunks_[_arg.desc_.get_access_index()](obj_, _arg.ptr_);
+  }
+
+private:
+  using thunk_t = result (*)(_Obj _Cls:: *, void *);
+
+  template<typename _Ty, bool _Lval>
+  static result thunk(_Obj _Cls:: *_obj, void *_ptr)
+  {
+    auto &v = *(_Ty *)_ptr;
+    if constexpr (_Lval)
+      return { std::invoke(_obj, v) };
+    else
+      return { std::invoke(_obj, std::move(v)) };
+  }
+
+  // one access path per cv and value category combination, indexed by type_desc::get_access_index
+  static constexpr thunk_t thunks_[] = {
+    &thunk<_Cls, true>, &thunk<const _Cls, true>, &thunk<volatile _Cls, true>, &thunk<volatile const _Cls, true>,
+    &thunk<_Cls, false>, &thunk<const _Cls, false>, &thunk<volatile _Cls, false>, &thunk<volatile const _Cls, false>
+  };
+
+  _Obj _Cls:: *obj_;
+};
+
+template<typename _Obj>
+class static_obj_wrapper : public obj_wrapper_base
+{
+public:
+  static_obj_wrapper(_Obj *_obj) : obj_(_obj)
+  {
+    field_ = field_info::make<_Obj>();
+    field_.addr_ = (void *)_obj;
+  }
+
+  result operator()(argument) override
+  {
+    // a static member or global doesn't take an object
+    assert(false);
+    return result();
+  }
+
+  result operator()() override
+  {
+    return { *obj_ };
+  }
+
+private:
+  _Obj *obj_;
+};
+
+// non-owning view over a container property, elements are reached in place without a result per element
+class container_view
+{
+public:
+  container_view() = default;
+  container_view(const container_ops *_ops, void *_obj, bool _con) : ops_(_ops), obj_(_obj), con_(_con) {}
+
+  bool is_null() const
+  {
+    return !ops_;
+  }
+
+  bool is_const() const
+  {
+    return con_;
+  }
+
+  size_t size() const
+  {
+    assert(ops_);
+    return ops_->size_(obj_);
+  }
+
+  const type_desc &get_elem_desc() const
+  {
+    assert(ops_);
+    return *ops_->elem_desc_;
+  }
+
+  size_t get_elem_size() const
+  {
+    assert(ops_);
+    return ops_->elem_size_;
+  }
+
+  bool is_contiguous() const
+  {
+    return ops_ && ops_->data_;
+  }
+
+  // nullptr unless the storage is contiguous
+  const void *data() const
+  {
+    assert(ops_);
+    return ops_->data_ ? ops_->data_(obj_) : nullptr;
+  }
+
+  // as data(), for writing through, the view must not be const
+  void *mutable_data() const
+  {
+    assert(ops_ && !con_);
+    return ops_->data_ ? ops_->data_(obj_) : nullptr;
+  }
+
+  // _fn gets a const void * to each element in iteration order
+  template <typename _Fn>
+  void for_each(_Fn &&_fn) const
+  {
+    assert(ops_);
+
+    using fn_t = std::remove_reference_t<_Fn>;
+    ops_->for_each_(obj_, [](void *_ctx, const void *_elem) { (*(fn_t *)_ctx)(_elem); }, (void *)&_fn);
+  }
+
+  void resize(size_t _cnt)
+  {
+    assert(ops_ && !con_ && ops_->resize_);
+    ops_->resize_(obj_, _cnt);
+  }
+
+  // copies _cnt elements of the element type from _elems to the end
+  void append(const void *_elems, size_t _cnt)
+  {
+    assert(ops_ && !con_ && ops_->append_);
+    ops_->append_(obj_, _elems, _cnt);
+  }
+
+  template <typename _Elem>
+  const _Elem *data_as() const
+  {
+    assert(get_type_desc<_Elem>().can_conv_to(get_elem_desc()));
+    return (const _Elem *)data();
+  }
+
+  template <typename _Elem>
+  _Elem *mutable_data_as() const
+  {
+    assert(get_type_desc<_Elem>().can_conv_to(get_elem_desc()));
+    return (_Elem *)mutable_data();
+  }
+
+private:
+  const container_ops *ops_ = nullptr;
+  void *obj_ = nullptr;
+  bool con_ = false;
+};
+
+class property
+{
+public:
+  property() = default;
+  property(symbol _sym, size_t _slot, std::unique_ptr<obj_wrapper_base> _obj) : null_(false), sym_(_sym), slot_(_slot), obj_(std::move(_obj)) {}
+
+  bool is_null() const
+  {
+    return null_;
+  }
+
+  symbol get_symbol() const
+  {
+    return sym_;
+  }
+
+  size_t get_slot() const
+  {
+    return slot_;
+  }
+
+  const field_info &get_field() const
+  {
+    assert(!null_);
+    return obj_->get_field();
+  }
+
+  // null view if the property isn't a standard container
+  template <typename _Ty>
+  container_view view(_Ty &&_arg) const
+  {
+    assert(!null_);
+
+    auto &f = obj_->get_field();
+    assert(f.member_ && f.cls_ == &get_type_desc<remove_cvref_t<_Ty>>());
+
+    if (!f.container_)
+      return {};
+
+    bool con = std::is_const_v<std::remove_reference_t<_Ty>> || f.desc_->get_cv_qualifier().con_;
+    return { f.container_, (char *)&_arg + f.offset_, con };
+  }
+
+  container_view view() const
+  {
+    assert(!null_);
+
+    auto &f = obj_->get_field();
+    assert(!f.member_);
+
+    if (!f.container_)
+      return {};
+
+    return { f.container_, f.addr_, f.desc_->get_cv_qualifier().con_ };
+  }
+
+  void track_dirty(dirty_fn _dirty)
+  {
+    dirty_ = _dirty;
+  }
+
+  template <typename _Obj, typename _Ty>
+  _Obj get(_Ty &&_arg) const
+  {
+    assert(!null_);
+    return (*obj_.get())({ (void*)&_arg, get_type_desc<_Ty &&>() }).template get<_Obj>();
+  }
+
+  template <typename _Obj, typename _Ty>
+  void set(_Ty &&_arg, _Obj &&_obj) const
+  {
+    assert(!null_);
+
+    auto &&res = (*obj_.get())({ (void *)& _arg, get_type_desc<_Ty &&>() });
+    res.template get<std::add_lvalue_reference_t<remove_cvref_t<_Obj>>>() = std::forward<_Obj>(_obj);
+
+    if (dirty_)
+      dirty_((void *)&_arg)->mark(slot_);
+  }
+
+  template <typename _Obj>
+  _Obj get() const
+  {
+    assert(!null_);
+    return (*obj_.get())().template get<_Obj>();
+  }
+
+  template <typename _Obj>
+  void set(_Obj &&_obj) const
+  {
+    assert(!null_);
+
+    auto &&res = (*obj_.get())();
+    res.template get<std::add_lvalue_reference_t<remove_cvref_t<_Obj>>>() = std::forward<_Obj>(_obj);
+  }
+
+private:
+  bool null_ = true;
+  symbol sym_ = null_symbol;
+  size_t slot_ = 0;
+  dirty_fn dirty_ = nullptr;
+  std::unique_ptr<obj_wrapper_base> obj_ = nullptr;
+};
+
+// compiled member path such as "a_.i_" or "items_[2].v_", see tr_info::compile_path
+class prop_path
+{
+public:
+  bool is_null() const
+  {
+    return null_;
+  }
+
+  // members and built-in arrays only, evaluation is a single pointer add
+  bool is_flat() const
+  {
+    return steps_.empty();
+  }
+
+  // the path must exist in _obj, see try_get
+  template <typename _Ty, typename _Cls>
+  _Ty &get(_Cls &_obj) const
+  {
+    auto res = try_get<_Ty>(_obj);
+    assert(res);
+
+    return *res;
+  }
+
+  // nullptr if a container index on the way is out of range
+  template <typename _Ty, typename _Cls>
+  _Ty *try_get(_Cls &_obj) const
+  {
+    static_assert(!std::is_const_v<_Cls> || std::is_const_v<_Ty>, "a const object only gives const access");
+    assert(!null_ && cls_ == &get_type_desc<std::remove_cv_t<_Cls>>() && desc_->can_conv_to(get_type_desc<_Ty &>()));
+    assert(!con_ || std::is_const_v<_Ty>);
+
+    return (_Ty *)eval((void *)&_obj);
+  }
+
+  // some member on the way is const
+  bool is_const() const
+  {
+    return con_;
+  }
+
+  // the whole path when it is flat
+  size_t get_offset() const
+  {
+    return offset_;
+  }
+
+  // layout of the field the path ends at
+  const field_info &get_leaf() const
+  {
+    assert(!null_);
+    return *leaf_;
+  }
+
+  // _obj must be of the type the path was compiled for, nullptr if a container index is out of range
+  void *address(void *_obj) const
+  {
+    assert(!null_);
+    return eval(_obj);
+  }
+
+  // type-erased compilation against the members of _cls
+  static prop_path compile(const field_info &_cls, std::string_view _path);
+
+private:
+  template <typename _Cls>
+  friend class tr_info;
+
+  struct step
+  {
+    void *(*elem_)(void *, size_t) = nullptr;
+    size_t idx_ = 0;
+    size_t offset_ = 0;
+  };
+
+  void *eval(void *_obj) const
+  {
+    auto p = (char *)_obj + offset_;
+    for (auto &s : steps_)
+    {
+      p = (char *)s.elem_(p, s.idx_);
+      if (!p)
+        return nullptr;
+
+      p += s.offset_;
+    }
+
+    return p;
+  }
+
+  bool null_ = true;
+  bool con_ = false;
+  const type_desc *cls_ = nullptr;
+  const type_desc *desc_ = nullptr;
+  const field_info *leaf_ = nullptr;
+  size_t offset_ = 0;
+  std::vector<step> steps_;
+};
+
+inline prop_path prop_path::compile(const field_info &_cls, std::string_view _path)
+{
+  prop_path res;
+
+  auto ident = [&]() {
+    size_t n = 0;
+    while (n < _path.size() && (isalnum((unsigned char)_path[n]) || _path[n] == '_'))
+      ++n;
+
+    auto name = _path.substr(0, n);
+    _path.remove_prefix(n);
+    return name;
+  };
+
+  auto member = [](const property *_prop) -> const field_info * {
+    if (!_prop || _prop->is_null() || !_prop->get_field().member_)
+      return nullptr;
+
+    return &_prop->get_field();
+  };
+
+  auto cur = _cls.child_ ? member(_cls.child_(ident())) : nullptr;
+  if (!cur)
+    return {};
+
+  size_t offset = cur->offset_;
+  while (!_path.empty())
+  {
+    res.con_ = res.con_ || cur->desc_->get_cv_qualifier().con_;
+
+    auto c = _path.front();
+    _path.remove_prefix(1);
+
+    if (c == '.')
+    {
+      auto name = ident();
+      auto next = cur->child_ ? member(cur->child_(name)) : nullptr;
+      if (!next)
+        return {};
+
+      offset += next->offset_;
+      cur = next;
+    }
+    else if (c == '[')
+    {
+      size_t idx = 0, n = 0;
+      for (; n < _path.size() && isdigit((unsigned char)_path[n]); ++n)
+      {
+        size_t digit = _path[n] - '0';
+        if (idx > (~size_t(0) - digit) / 10)
+          return {};
+
+        idx = idx * 10 + digit;
+      }
+
+      if (!n || n >= _path.size() || _path[n] != ']' || !cur->elem_info_)
+        return {};
+
+      _path.remove_prefix(n + 1);
+
+      if (cur->elem_)
+      {
+        (res.steps_.empty() ? res.offset_ : res.steps_.back().offset_) = offset;
+        res.steps_.push_back({ cur->elem_, idx, 0 });
+        offset = 0;
+      }
+      else if (idx < cur->elem_cnt_)
+        offset += idx * cur->elem_size_;
+      else
+        return {};
+
+      cur = cur->elem_info_();
+    }
+    else
+      return {};
+  }
+
+  (res.steps_.empty() ? res.offset_ : res.steps_.back().offset_) = offset;
+  res.null_ = false;
+  res.desc_ = cur->desc_;
+  res.leaf_ = cur;
+
+  return res;
+}
+
+// field-level delta between two objects of one reflected type, see tr_info::diff
+class patch
+{
+public:
+  bool is_null() const
+  {
+    return null_;
+  }
+
+  bool empty() const
+  {
+    return bytes_.empty() && fields_.empty() && objs_.empty();
+  }
+
+  // encoded runs of raw bytes: varint offset, varint length, bytes
+  const std::vector<uint8_t> &get_bytes() const
+  {
+    return bytes_;
+  }
+
+  // number of changed fields that aren't sent as raw bytes, see is_raw_wire
+  size_t get_obj_cnt() const
+  {
+    return field_cnt_ + objs_.size();
+  }
+
+  // varint length and the runs, then varint count and the fields as varint slot, varint length, codec bytes,
+  // empty if a changed field has no codec and only lives in this process
+  std::vector<uint8_t> encode() const
+  {
+    assert(!null_);
+
+    std::vector<uint8_t> res;
+    if (!objs_.empty())
+      return res;
+
+    res.reserve(bytes_.size() + fields_.size() + 8);
+    put_varint(res, bytes_.size());
+    res.insert(res.end(), bytes_.begin(), bytes_.end());
+    put_varint(res, field_cnt_);
+    res.insert(res.end(), fields_.begin(), fields_.end());
+
+    return res;
+  }
+
+  // checks the framing only, the runs and fields are checked against the type by tr_info::apply_patch,
+  // malformed input gives a null patch
+  static patch decode(const uint8_t *_data, size_t _len)
+  {
+    patch res;
+
+    auto p = _data, end = _data + _len;
+    size_t len = 0;
+    if (!get_varint(p, end, len) || len > size_t(end - p))
+      return null_patch();
+
+    res.bytes_.assign(p, p + len);
+    p += len;
+
+    for (const uint8_t *q = res.bytes_.data(), *q_end = q + len; q < q_end; )
+    {
+      size_t offset = 0, run = 0;
+      if (!get_varint(q, q_end, offset) || !get_varint(q, q_end, run) || run > size_t(q_end - q))
+        return null_patch();
+
+      q += run;
+    }
+
+    if (!get_varint(p, end, res.field_cnt_))
+      return null_patch();
+
+    res.fields_.assign(p, end);
+    for (size_t i = 0; i < res.field_cnt_; ++i)
+    {
+      size_t slot = 0;
+      if (!get_varint(p, end, slot) || !get_varint(p, end, len) || len > size_t(end - p))
+        return null_patch();
+
+      p += len;
+    }
+
+    if (p != end)
+      return null_patch();
+
+    return res;
+  }
+
+private:
+  template <typename _Cls>
+  friend class tr_info;
+
+  static patch null_patch()
+  {
+    patch res;
+    res.null_ = true;
+    return res;
+  }
+
+  void put_run(const void *_src, size_t _offset, size_t _len)
+  {
+    put_varint(bytes_, _offset);
+    put_varint(bytes_, _len);
+
+    auto p = (const uint8_t *)_src + _offset;
+    bytes_.insert(bytes_.end(), p, p + _len);
+  }
+
+  // a field through its codec, false if it has none
+  bool put_field(const field_info &_field, size_t _slot, const void *_src)
+  {
+    if (!_field.encode_)
+      return false;
+
+    auto mark = fields_.size();
+    put_varint(fields_, _slot);
+
+    auto val = fields_.size();
+    if (!_field.encode_((const char *)_src + _field.offset_, fields_))
+    {
+      fields_.resize(mark);
+      return false;
+    }
+
+    // the length goes in front of the value once it is known
+    std::vector<uint8_t> len;
+    put_varint(len, fields_.size() - val);
+    fields_.insert(fields_.begin() + val, len.begin(), len.end());
+    ++field_cnt_;
+
+    return true;
+  }
+
+  bool null_ = false;
+  // the type diff ran on, nullptr for a decoded patch
+  const type_desc *cls_ = nullptr;
+  std::vector<uint8_t> bytes_;
+  std::vector<uint8_t> fields_;
+  size_t field_cnt_ = 0;
+  // fields without a codec, as copies of the new values
+  std::vector<std::pair<size_t, std::shared_ptr<void>>> objs_;
+};
+
+template <typename _Cls>
+class tr_info
+{
+public:
+  using cls_t = _Cls;
+
+  // registration bodies written against the original TR_INIT name the type as TR_TY
+  using TR_TY = _Cls;
+
+  tr_info()
+  {
+    init();
+    link_setters();
+    build_layout();
+
+    // registration is over, drop the growth slack of the lookup tables
+    method_idx_.slots_.shrink_to_fit();
+    property_idx_.slots_.shrink_to_fit();
+    method_names_.shrink_to_fit();
+    property_names_.shrink_to_fit();
+  }
+
+  void init() {}
+
+  template<typename _Fn, typename = std::enable_if_t<std::is_function_v<_Fn>>>
+  void add_method(std::string_view _name, _Fn _Cls:: * _fn)
+  {
+    assert(_fn);
+    add_fn(_name, std::make_unique<fn_wrapper<_Fn _Cls:: *>>(_fn));
+  }
+
+  // static member function, or free function when _Cls is a namespace tag
+  template<typename _Fn, typename = std::enable_if_t<std::is_function_v<_Fn>>>
+  void add_method(std::string_view _name, _Fn * _fn)
+  {
+    assert(_fn);
+    add_fn(_name, std::make_unique<fn_wrapper<_Fn *>>(_fn));
+  }
+
+  // a method that changes property _prop, calling it through reflection marks the property dirty
+  template<typename _Fn, typename = std::enable_if_t<std::is_function_v<_Fn>>>
+  void add_setter(std::string_view _name, _Fn _Cls:: * _fn, std::string_view _prop)
+  {
+    add_method<_Fn>(_name, _fn);
+    setters_.emplace_back(symbol_pool::instance().intern(_name), symbol_pool::instance().intern(_prop));
+  }
+
+  template<typename _Obj, typename = std::enable_if_t<std::is_object_v<_Obj>>>
+  void add_property(std::string_view _name, _Obj _Cls:: * _obj)
+  {
+    assert(_obj);
+    add_obj(_name, std::make_unique<obj_wrapper<_Cls, _Obj>>(_obj));
+  }
+
+  // static data member, or global variable when _Cls is a namespace tag
+  template<typename _Obj, typename = std::enable_if_t<std::is_object_v<_Obj>>>
+  void add_property(std::string_view _name, _Obj * _obj)
+  {
+    assert(_obj);
+    add_obj(_name, std::make_unique<static_obj_wrapper<_Obj>>(_obj));
+  }
+
+  // the views point into the symbol pool, they stay valid for the whole process
+  const std::vector<std::string_view> &get_method_names() const { return method_names_; }
+
+  const std::vector<std::string_view> &get_property_names() const { return property_names_; }
+
+  const method &get_method(symbol _sym) const
+  {
+    auto idx = method_idx_.find(_sym);
+    return idx == member_index::npos ? null_method_ : methods_[idx];
+  }
+
+  const method &get_method(std::string_view _name) const
+  {
+    auto idx = method_idx_.find(_name);
+    return idx == member_index::npos ? null_method_ : methods_[idx];
+  }
+
+  const property &get_property(symbol _sym) const
+  {
+    auto idx = property_idx_.find(_sym);
+    return idx == member_index::npos ? null_property_ : properties_[idx];
+  }
+
+  const property &get_property(std::string_view _name) const
+  {
+    auto idx = property_idx_.find(_name);
+    return idx == member_index::npos ? null_property_ : properties_[idx];
+  }
+
+  // setting a property through reflection, or calling one of its setters, marks its slot in the object's dirty_set
+  template<auto _Dirty>
+  void track_dirty()
+  {
+    dirty_ = [](void *_obj) { return &(((_Cls *)_obj)->*_Dirty); };
+    for (auto &p : properties_)
+      p.track_dirty(dirty_);
+  }
+
+  using observer = std::function<void(_Cls &, const std::vector<size_t> &)>;
+
+  // observers get the changed slots of an object once per flush
+  void add_observer(observer _observer) const
+  {
+    std::unique_lock lock(observer_mtx_);
+
+    // copy on write, a flush in progress keeps calling the list it started with
+    auto observers = observers_ ? std::make_shared<std::vector<observer>>(*observers_) : std::make_shared<std::vector<observer>>();
+    observers->push_back(std::move(_observer));
+    observers_ = std::move(observers);
+  }
+
+  // observers run without a lock held, so they may add observers or flush other objects
+  void flush(_Cls &_obj) const
+  {
+    assert(dirty_);
+
+    auto &dirty = *dirty_(&_obj);
+    if (!dirty.any())
+      return;
+
+    std::shared_ptr<const std::vector<observer>> observers;
+    {
+      std::shared_lock lock(observer_mtx_);
+      observers = observers_;
+    }
+
+    // the slot buffer is reused per thread, a nested flush takes it over and starts with an empty one
+    thread_local std::vector<size_t> buf;
+    std::vector<size_t> slots;
+    slots.swap(buf);
+    slots.clear();
+
+    dirty.for_each([&](size_t _slot) { slots.push_back(_slot); });
+    dirty.clear();
+
+    if (observers)
+    {
+      for (auto &o : *observers)
+        o(_obj, slots);
+    }
+
+    buf.swap(slots);
+  }
+
+  // delta that turns _from into _to, memcmp over merged spans of bitwise comparable fields
+  patch diff(const _Cls &_from, const _Cls &_to) const
+  {
+    patch res;
+    res.cls_ = &get_type_desc<_Cls>();
+    auto from = (const char *)&_from, to = (const char *)&_to;
+
+    for (auto &s : wire_.spans_)
+    {
+      if (memcmp(from + s.offset_, to + s.offset_, s.size_) == 0)
+        continue;
+
+      // coalesce adjacent changed fields into one run
+      size_t run_off = 0, run_len = 0;
+      for (size_t i = s.first_; i < s.last_; ++i)
+      {
+        auto &f = *wire_.bitwise_[i];
+        if (memcmp(from + f.offset_, to + f.offset_, f.size_) == 0)
+          continue;
+
+        if (run_len && run_off + run_len == f.offset_)
+          run_len += f.size_;
+        else
+        {
+          if (run_len)
+            res.put_run(to, run_off, run_len);
+
+          run_off = f.offset_;
+          run_len = f.size_;
+        }
+      }
+
+      if (run_len)
+        res.put_run(to, run_off, run_len);
+    }
+
+    for (auto slot : wire_.others_)
+    {
+      auto &f = properties_[slot].get_field();
+      if (changed(f, from, to) && !res.put_field(f, slot, to) && f.clone_)
+        res.objs_.emplace_back(slot, f.clone_(to + f.offset_));
+    }
+
+    return res;
+  }
+
+  // false if the patch is null, malformed or doesn't fit this type, the object is left untouched then
+  bool apply_patch(_Cls &_obj, const patch &_patch) const
+  {
+    if (_patch.is_null() || (_patch.cls_ && _patch.cls_ != &get_type_desc<_Cls>()))
+      return false;
+
+    auto obj = (char *)&_obj;
+
+    auto p = _patch.bytes_.data(), end = p + _patch.bytes_.size();
+    while (p < end)
+    {
+      size_t offset = 0, len = 0;
+      if (!get_varint(p, end, offset) || !get_varint(p, end, len) || len > size_t(end - p) || !walk_run(offset, len, nullptr))
+        return false;
+
+      p += len;
+    }
+
+    // fields decode into copies first, so a malformed value changes nothing
+    std::vector<std::pair<size_t, std::shared_ptr<void>>> vals;
+    p = _patch.fields_.data(), end = p + _patch.fields_.size();
+    for (size_t i = 0; i < _patch.field_cnt_; ++i)
+    {
+      size_t slot = 0, len = 0;
+      if (!get_varint(p, end, slot) || !get_varint(p, end, len) || len > size_t(end - p) || slot >= properties_.size())
+        return false;
+
+      auto &f = properties_[slot].get_field();
+      if (!f.member_ || !f.writable_ || !f.decode_ || !f.clone_ || !f.assign_)
+        return false;
+
+      auto val = f.clone_(obj + f.offset_);
+      auto q = p;
+      if (!f.decode_(val.get(), q, p + len) || q != p + len)
+        return false;
+
+      vals.emplace_back(slot, std::move(val));
+      p += len;
+    }
+
+    if (p != end)
+      return false;
+
+    auto dirty = dirty_ ? dirty_(&_obj) : nullptr;
+
+    p = _patch.bytes_.data(), end = p + _patch.bytes_.size();
+    while (p < end)
+    {
+      size_t offset = 0, len = 0;
+      get_varint(p, end, offset);
+      get_varint(p, end, len);
+
+      memcpy(obj + offset, p, len);
+      p += len;
+
+      if (dirty)
+        walk_run(offset, len, dirty);
+    }
+
+    vals.insert(vals.end(), _patch.objs_.begin(), _patch.objs_.end());
+    for (auto &[slot, val] : vals)
+    {
+      auto &f = properties_[slot].get_field();
+      f.assign_(obj + f.offset_, val.get());
+
+      if (dirty)
+        dirty->mark(slot);
+    }
+
+    return true;
+  }
+
+  // the registered writable member fields in slot order behind a varint count, false if one has no codec
+  bool encode(const _Cls &_obj, std::vector<uint8_t> &_out) const
+  {
+    if (!is_reflected())
+      return false;
+
+    auto obj = (const char *)&_obj;
+    put_varint(_out, codec_.size());
+    for (auto slot : codec_)
+    {
+      auto &f = properties_[slot].get_field();
+      if (!f.encode_ || !f.encode_(obj + f.offset_, _out))
+        return false;
+    }
+
+    return true;
+  }
+
+  bool decode(_Cls &_obj, const uint8_t *&_p, const uint8_t *_end) const
+  {
+    size_t cnt = 0;
+    if (!is_reflected() || !get_varint(_p, _end, cnt) || cnt != codec_.size())
+      return false;
+
+    auto obj = (char *)&_obj;
+    for (auto slot : codec_)
+    {
+      auto &f = properties_[slot].get_field();
+      if (!f.decode_ || !f.decode_(obj + f.offset_, _p, _end))
+        return false;
+    }
+
+    return true;
+  }
+
+  bool is_reflected() const
+  {
+    return !properties_.empty();
+  }
+
+  // a malformed path or an unknown member gives a null prop_path
+  prop_path compile_path(std::string_view _path) const
+  {
+    auto res = prop_path::compile(field_info::of<_Cls>(), _path);
+    if (!res.is_null())
+      res.cls_ = &get_type_desc<_Cls>();
+
+    return res;
+  }
+
+  // compares the registered member fields, const ones included, fields that can't be compared are skipped
+  bool equal(const _Cls &_a, const _Cls &_b) const
+  {
+    auto a = (const char *)&_a, b = (const char *)&_b;
+
+    for (auto &s : cmp_.spans_)
+    {
+      if (memcmp(a + s.offset_, b + s.offset_, s.size_) != 0)
+        return false;
+    }
+
+    for (auto slot : cmp_.others_)
+    {
+      auto &f = properties_[slot].get_field();
+      if (f.equal_ && !f.equal_(a + f.offset_, b + f.offset_))
+        return false;
+    }
+
+    return true;
+  }
+
+  // consistent with equal(), fields without a hash function don't contribute
+  size_t hash(const _Cls &_obj) const
+  {
+    auto obj = (const char *)&_obj;
+
+    uint64_t h = 0;
+    for (auto &s : cmp_.spans_)
+      h = hash_bytes(obj + s.offset_, s.size_, h);
+
+    for (auto slot : cmp_.others_)
+    {
+      auto &f = properties_[slot].get_field();
+      if (f.hash_)
+        h = hash_mix(h ^ f.hash_(obj + f.offset_));
+    }
+
+    return (size_t)h;
+  }
+
+  // default constructs and copies the registered writable fields, the others keep their default values
+  _Cls clone(const _Cls &_obj) const
+  {
+    _Cls res{};
+    auto src = (const char *)&_obj;
+    auto dest = (char *)&res;
+
+    for (auto &s : copy_.spans_)
+      memcpy(dest + s.offset_, src + s.offset_, s.size_);
+
+    for (auto slot : copy_.others_)
+    {
+      auto &f = properties_[slot].get_field();
+      if (f.assign_)
+        f.assign_(dest + f.offset_, src + f.offset_);
+    }
+
+    return res;
+  }
+
+private:
+  // member slots sorted by symbol, 8 bytes per member, filled during registration and read-only afterwards
+  struct member_index
+  {
+    static constexpr size_t npos = ~size_t(0);
+
+    size_t find(symbol _sym) const
+    {
+      auto ite = std::lower_bound(slots_.begin(), slots_.end(), _sym, less);
+      return ite == slots_.end() || ite->first != _sym ? npos : ite->second;
+    }
+
+    // a name that was never interned can't be a member
+    size_t find(std::string_view _name) const
+    {
+      auto sym = symbol_pool::instance().find(_name);
+      return sym == null_symbol ? npos : find(sym);
+    }
+
+    void add(symbol _sym, size_t _idx)
+    {
+      slots_.emplace(std::lower_bound(slots_.begin(), slots_.end(), _sym, less), _sym, (uint32_t)_idx);
+    }
+
+    static bool less(const std::pair<symbol, uint32_t> &_slot, symbol _sym)
+    {
+      return _slot.first < _sym;
+    }
+
+    std::vector<std::pair<symbol, uint32_t>> slots_;
+  };
+
+  struct span
+  {
+    size_t offset_ = 0;
+    size_t size_ = 0;
+    size_t first_ = 0;
+    size_t last_ = 0;
+  };
+
+  // member fields with adjacent bitwise comparable ones merged into spans,
+  // a wire layout only spans the fields that are sent as raw bytes
+  struct layout
+  {
+    void build(const std::vector<property> &_properties, bool _writable, bool _wire)
+    {
+      for (auto &p : _properties)
+      {
+        auto &f = p.get_field();
+        if (!f.member_ || (_writable && !f.writable_))
+          continue;
+
+        if (_wire ? f.raw_wire_ : f.bitwise_)
+          bitwise_.push_back(&f);
+        else
+          others_.push_back(p.get_slot());
+      }
+
+      std::sort(bitwise_.begin(), bitwise_.end(), [](const field_info *_a, const field_info *_b) { return _a->offset_ < _b->offset_; });
+
+      for (size_t i = 0; i < bitwise_.size(); ++i)
+      {
+        auto &f = *bitwise_[i];
+        if (!spans_.empty() && spans_.back().offset_ + spans_.back().size_ == f.offset_)
+        {
+          spans_.back().size_ += f.size_;
+          spans_.back().last_ = i + 1;
+        }
+        else
+          spans_.push_back({ f.offset_, f.size_, i, i + 1 });
+      }
+    }
+
+    std::vector<const field_info *> bitwise_;
+    std::vector<span> spans_;
+    std::vector<size_t> others_;
+  };
+
+  void link_setters()
+  {
+    for (auto &[m, p] : setters_)
+    {
+      auto &prop = get_property(p);
+      assert(!prop.is_null());
+
+      if (dirty_)
+        methods_[method_idx_.find(m)].track_dirty(dirty_, prop.get_slot());
+    }
+  }
+
+  // a field that can't be compared always counts as changed
+  static bool changed(const field_info &_f, const char *_a, const char *_b)
+  {
+    if (!_f.equal_ || (_f.reflected_ && !_f.reflected_()))
+      return true;
+
+    return !_f.equal_(_a + _f.offset_, _b + _f.offset_);
+  }
+
+  void build_layout()
+  {
+    copy_.build(properties_, true, false);
+    cmp_.build(properties_, false, false);
+    wire_.build(properties_, true, true);
+
+    for (auto &p : properties_)
+    {
+      auto &f = p.get_field();
+      if (!f.member_ || !f.writable_)
+        continue;
+
+      codec_.push_back(p.get_slot());
+      if (f.raw_wire_)
+        runs_.push_back({ f.offset_, f.size_, p.get_slot() });
+    }
+
+    std::sort(runs_.begin(), runs_.end(), [](const run_field &_a, const run_field &_b) { return _a.offset_ < _b.offset_; });
+  }
+
+  // true if [_offset, _offset + _len) is exactly a sequence of adjacent writable raw wire fields,
+  // which are marked in _dirty when given
+  bool walk_run(size_t _offset, size_t _len, dirty_set *_dirty) const
+  {
+    auto ite = std::lower_bound(runs_.begin(), runs_.end(), _offset, [](const run_field &_f, size_t _off) { return _f.offset_ < _off; });
+
+    auto pos = _offset, end = _offset + _len;
+    if (end < _offset)
+      return false;
+
+    for (; pos < end && ite != runs_.end() && ite->offset_ == pos; ++ite)
+    {
+      pos += ite->size_;
+      if (_dirty)
+        _dirty->mark(ite->slot_);
+    }
+
+    return _len && pos == end;
+  }
+
+  void add_fn(std::string_view _name, std::unique_ptr<fn_wrapper_base> _fn)
+  {
+    auto sym = symbol_pool::instance().intern(_name);
+
+    // a known name adds an overload
+    auto idx = method_idx_.find(sym);
+    if (idx != member_index::npos)
+      return methods_[idx].add_overload(std::move(_fn));
+
+    auto name = symbol_pool::instance().name(sym);
+    method_idx_.add(sym, methods_.size());
+    method_names_.push_back(name);
+    methods_.emplace_back(sym, std::move(_fn));
+  }
+
+  void add_obj(std::string_view _name, std::unique_ptr<obj_wrapper_base> _obj)
+  {
+    auto sym = symbol_pool::instance().intern(_name);
+    assert(property_idx_.find(sym) == member_index::npos);
+
+    auto name = symbol_pool::instance().name(sym);
+    property_idx_.add(sym, properties_.size());
+    property_names_.push_back(name);
+    properties_.emplace_back(sym, properties_.size(), std::move(_obj));
+    properties_.back().track_dirty(dirty_);
+  }
+
+  std::vector<std::string_view> method_names_;
+  std::vector<std::string_view> property_names_;
+
+  std::vector<method> methods_;
+  std::vector<property> properties_;
+
+  member_index method_idx_;
+  member_index property_idx_;
+
+  // setter and property symbols, see add_setter
+  std::vector<std::pair<symbol, symbol>> setters_;
+
+  dirty_fn dirty_ = nullptr;
+
+  layout copy_;
+  layout cmp_;
+  layout wire_;
+
+  struct run_field
+  {
+    size_t offset_ = 0;
+    size_t size_ = 0;
+    size_t slot_ = 0;
+  };
+
+  // writable raw wire member fields by offset, a patch run must line up with them
+  std::vector<run_field> runs_;
+  // writable member fields, see encode
+  std::vector<size_t> codec_;
+
+  mutable std::shared_mutex observer_mtx_;
+  mutable std::shared_ptr<const std::vector<observer>> observers_;
+
+  static inline method null_method_;
+  static inline property null_property_;
+};
+
+template <typename _Cls>
+const tr_info<_Cls> &get_tr_info()
+{
+  // thread-safe, registration runs on first access only
+  static tr_info<_Cls> info;
+  return info;
+}
+
+// register the given types up front instead of on first access
+template <typename... _Cls>
+void preload()
+{
+  (get_tr_info<_Cls>(), ...);
+}
+
+// constant-initialized handle, so no registration happens during static initialization,
+// the lookups forward to tr_info, anything else is reached as tr_data<T>->member
+template <typename _Cls>
+struct tr_handle
+{
+  const tr_info<_Cls> &get() const { return get_tr_info<_Cls>(); }
+
+  const tr_info<_Cls> *operator->() const { return &get(); }
+
+  const std::vector<std::string_view> &get_method_names() const { return get().get_method_names(); }
+
+  const std::vector<std::string_view> &get_property_names() const { return get().get_property_names(); }
+
+  const method &get_method(symbol _sym) const { return get().get_method(_sym); }
+
+  const method &get_method(std::string_view _name) const { return get().get_method(_name); }
+
+  const property &get_property(symbol _sym) const { return get().get_property(_sym); }
+
+  const property &get_property(std::string_view _name) const { return get().get_property(_name); }
 };
 
 template <typename _Ty>
-inline tr_info<_Ty> tr_data;
+inline constexpr tr_handle<_Ty> tr_data{};
+
+template <typename _Cls>
+patch diff(const _Cls &_from, const _Cls &_to)
+{
+  return get_tr_info<_Cls>().diff(_from, _to);
+}
+
+template <typename _Cls>
+bool apply_patch(_Cls &_obj, const patch &_patch)
+{
+  return get_tr_info<_Cls>().apply_patch(_obj, _patch);
+}
+
+template <typename _Cls>
+prop_path compile_path(std::string_view _path)
+{
+  return get_tr_info<_Cls>().compile_path(_path);
+}
+
+template <typename _Cls>
+bool reflect_equal(const _Cls &_a, const _Cls &_b)
+{
+  return get_tr_info<_Cls>().equal(_a, _b);
+}
+
+template <typename _Cls>
+size_t reflect_hash(const _Cls &_obj)
+{
+  return get_tr_info<_Cls>().hash(_obj);
+}
+
+template <typename _Cls>
+_Cls reflect_clone(const _Cls &_obj)
+{
+  return get_tr_info<_Cls>().clone(_obj);
+}
+
+// for std::unordered_map<_Cls, _Val, reflect_hasher<_Cls>, reflect_equal_to<_Cls>>
+template <typename _Cls>
+struct reflect_hasher
+{
+  size_t operator()(const _Cls &_obj) const { return reflect_hash(_obj); }
+};
+
+template <typename _Cls>
+struct reflect_equal_to
+{
+  bool operator()(const _Cls &_a, const _Cls &_b) const { return reflect_equal(_a, _b); }
+};
 
 #define TR_INIT(t)  \
-  using TR_TY = t; \
   template <>       \
   void tr_info<t>::init()
 
-#define TR_PROPERTY(p) add_property(#p, &TR_TY::p)
-#define TR_METHOD(m) add_method(#m, &TR_TY::m)
\ No newline at end of file
+#define TR_PROPERTY(p) add_property(#p, &cls_t::p)
+#define TR_METHOD(m) add_method(#m, &cls_t::m)
+#define TR_OVERLOAD(m, sig) add_method<sig>(#m, &cls_t::m)
+#define TR_SETTER(m, p) add_setter(#m, &cls_t::m, #p)
+#define TR_DIRTY(d) track_dirty<&cls_t::d>()
+
+// namespace-level registration, any tag type can stand for the namespace, e.g.
+//   struct my_ns {};
+//   TR_INIT(my_ns) { TR_FUNCTION(clamp); TR_VARIABLE(tick_rate); }
+#define TR_FUNCTION(f) add_method(#f, &f)
+#define TR_FUNCTION_OVERLOAD(f, sig) add_method<sig>(#f, &f)
+#define TR_VARIABLE(v) add_property(#v, &v)
@@ -0,0 +1,886 @@
+#pragma once
+
+#include "cpptr.h"
+
+#include <cerrno>
+
+// compiled arithmetic and logical expressions over reflected objects, e.g.
+//   auto e = compile_expr<st>("obj.get_a().i_ > 10 && obj.c_a_.i_ < 200");
+//   bool hit = e.eval<bool>(s);
+// member names are resolved once at compile time, evaluation runs a register based bytecode
+// with unboxed scalar registers, a load through a container index out of range reads as 0 or false
+// and the rest of the expression is evaluated as usual,
+// mixing signed and unsigned 64-bit integers converts to unsigned as in C
+
+constexpr size_t expr_max_regs = 32;
+constexpr size_t expr_max_obj_regs = 16;
+constexpr size_t expr_max_calls = 16;
+
+enum class expr_op : uint8_t
+{
+  imm, mov, i2d, u2d, i2b, d2b,
+  load_off, load_path, obj_off, obj_path, call_obj, call_scalar,
+  add_i, sub_i, mul_i, div_i, mod_i, neg_i, div_u, mod_u,
+  add_d, sub_d, mul_d, div_d, neg_d,
+  lt_i, le_i, eq_i, ne_i, lt_u, le_u,
+  lt_d, le_d, eq_d, ne_d,
+  not_b, jz, jnz
+};
+
+struct expr_insn
+{
+  expr_op op_ = expr_op::imm;
+  uint8_t dst_ = 0;
+  uint8_t a_ = 0;
+  uint8_t b_ = 0;
+
+  // offset, path, call or jump target depending on op_, b_ is the temporary of a call_obj
+  size_t idx_ = 0;
+  scalar imm_ = {};
+  void (*load_)(const void *, scalar &) = nullptr;
+};
+
+template <typename _Cls>
+class expr_compiler;
+
+template <typename _Cls>
+class expr
+{
+public:
+  bool is_null() const
+  {
+    return code_.empty();
+  }
+
+  // why compilation failed, empty otherwise
+  const std::string &get_error() const
+  {
+    return error_;
+  }
+
+  scalar_kind get_kind() const
+  {
+    return kind_;
+  }
+
+  // true if a called method takes the object as non-const, such an expr can't evaluate const objects
+  bool is_mutating() const
+  {
+    return mutating_;
+  }
+
+  template <typename _Ty>
+  _Ty eval(_Cls &_obj) const
+  {
+    assert(!is_null());
+
+    scalar regs[expr_max_regs];
+    void *objs[expr_max_obj_regs];
+    temps tmps(tmp_cnt_);
+
+    return convert<_Ty>(run(&_obj, regs, objs, tmps.get()));
+  }
+
+  // one compiled expression over a batch of objects, the registers are set up once
+  template <typename _Ty>
+  void eval(_Cls *_objs, size_t _cnt, _Ty *_out) const
+  {
+    assert(!is_null());
+
+    scalar regs[expr_max_regs];
+    void *objs[expr_max_obj_regs];
+    temps tmps(tmp_cnt_);
+
+    for (size_t i = 0; i < _cnt; ++i)
+      _out[i] = convert<_Ty>(run(_objs + i, regs, objs, tmps.get()));
+  }
+
+  template <typename _Ty>
+  void eval(_Cls *const *_objs, size_t _cnt, _Ty *_out) const
+  {
+    assert(!is_null());
+
+    scalar regs[expr_max_regs];
+    void *objs[expr_max_obj_regs];
+    temps tmps(tmp_cnt_);
+
+    for (size_t i = 0; i < _cnt; ++i)
+      _out[i] = convert<_Ty>(run(_objs[i], regs, objs, tmps.get()));
+  }
+
+  template <typename _Ty>
+  _Ty eval(const _Cls &_obj) const
+  {
+    assert(!mutating_);
+    return eval<_Ty>(const_cast<_Cls &>(_obj));
+  }
+
+  template <typename _Ty>
+  void eval(const _Cls *_objs, size_t _cnt, _Ty *_out) const
+  {
+    assert(!mutating_);
+    eval(const_cast<_Cls *>(_objs), _cnt, _out);
+  }
+
+  template <typename _Ty>
+  void eval(const _Cls *const *_objs, size_t _cnt, _Ty *_out) const
+  {
+    assert(!mutating_);
+    eval(const_cast<_Cls *const *>(_objs), _cnt, _out);
+  }
+
+private:
+  friend class expr_compiler<_Cls>;
+
+  struct call
+  {
+    fn_wrapper_base *fn_ = nullptr;
+    const type_desc *desc_ = nullptr;
+  };
+
+  // objects returned by call_obj, only as many are constructed as the expression has such calls
+  class temps
+  {
+  public:
+    explicit temps(size_t _cnt) : cnt_(_cnt)
+    {
+      for (size_t i = 0; i < cnt_; ++i)
+        new (get() + i) result();
+    }
+
+    temps(const temps &) = delete;
+    temps &operator=(const temps &) = delete;
+
+    ~temps()
+    {
+      for (size_t i = 0; i < cnt_; ++i)
+        get()[i].~result();
+    }
+
+    result *get()
+    {
+      return (result *)&buf_;
+    }
+
+  private:
+    size_t cnt_;
+    std::aligned_storage_t<sizeof(result) * expr_max_calls, alignof(result)> buf_;
+  };
+
+  template <typename _Ty>
+  _Ty convert(scalar _val) const
+  {
+    if constexpr (std::is_same_v<_Ty, bool>)
+      return kind_ == scalar_kind::floating ? _val.d_ != 0 : _val.i_ != 0;
+    else if (kind_ == scalar_kind::floating)
+      return (_Ty)_val.d_;
+    else if (kind_ == scalar_kind::unsigned_integer)
+      return (_Ty)_val.u_;
+    else
+      return (_Ty)_val.i_;
+  }
+
+  scalar run(void *_obj, scalar *_r, void **_o, result *_t) const
+  {
+    _o[0] = _obj;
+
+    auto code = code_.data();
+    size_t pc = 0, end = code_.size();
+    while (pc < end)
+    {
+      auto &in = code[pc++];
+      auto &d = _r[in.dst_];
+      auto &a = _r[in.a_];
+      auto &b = _r[in.b_];
+
+      switch (in.op_)
+      {
+      case expr_op::imm: d = in.imm_; break;
+      case expr_op::mov: d = a; break;
+      case expr_op::i2d: d.d_ = (double)a.i_; break;
+      case expr_op::u2d: d.d_ = (double)a.u_; break;
+      case expr_op::i2b: d.i_ = a.i_ != 0; break;
+      case expr_op::d2b: d.i_ = a.d_ != 0; break;
+
+      // an index out of range leaves a null object register, anything read through it is 0
+      case expr_op::load_off:
+      {
+        if (_o[in.a_])
+          in.load_((char *)_o[in.a_] + in.idx_, d);
+        else
+          d = {};
+
+        break;
+      }
+
+      case expr_op::obj_off: _o[in.dst_] = _o[in.a_] ? (char *)_o[in.a_] + in.idx_ : nullptr; break;
+
+      case expr_op::load_path:
+      {
+        auto p = _o[in.a_] ? paths_[in.idx_].address(_o[in.a_]) : nullptr;
+        if (p)
+          in.load_(p, d);
+        else
+          d = {};
+
+        break;
+      }
+
+      case expr_op::obj_path: _o[in.dst_] = _o[in.a_] ? paths_[in.idx_].address(_o[in.a_]) : nullptr; break;
+
+      case expr_op::call_obj:
+      {
+        auto &c = calls_[in.idx_];
+        if (!_o[in.a_])
+        {
+          _o[in.dst_] = nullptr;
+          break;
+        }
+
+        _t[in.b_] = (*c.fn_)({ _o[in.a_], *c.desc_ });
+        _o[in.dst_] = _t[in.b_].get_address();
+        break;
+      }
+
+      // an arithmetic return goes straight into the register
+      case expr_op::call_scalar:
+      {
+        if (_o[in.a_])
+          calls_[in.idx_].fn_->invoke_scalar(_o[in.a_], d);
+        else
+          d = {};
+
+        break;
+      }
+
+      // wrap around instead of overflowing
+      case expr_op::add_i: d.i_ = (int64_t)((uint64_t)a.i_ + (uint64_t)b.i_); break;
+      case expr_op::sub_i: d.i_ = (int64_t)((uint64_t)a.i_ - (uint64_t)b.i_); break;
+      case expr_op::mul_i: d.i_ = (int64_t)((uint64_t)a.i_ * (uint64_t)b.i_); break;
+      case expr_op::div_i: d.i_ = b.i_ == 0 ? 0 : b.i_ == -1 ? (int64_t)(0 - (uint64_t)a.i_) : a.i_ / b.i_; break;
+      case expr_op::mod_i: d.i_ = b.i_ == 0 || b.i_ == -1 ? 0 : a.i_ % b.i_; break;
+      case expr_op::neg_i: d.i_ = (int64_t)(0 - (uint64_t)a.i_); break;
+      case expr_op::div_u: d.u_ = b.u_ == 0 ? 0 : a.u_ / b.u_; break;
+      case expr_op::mod_u: d.u_ = b.u_ == 0 ? 0 : a.u_ % b.u_; break;
+
+      case expr_op::add_d: d.d_ = a.d_ + b.d_; break;
+      case expr_op::sub_d: d.d_ = a.d_ - b.d_; break;
+      case expr_op::mul_d: d.d_ = a.d_ * b.d_; break;
+      case expr_op::div_d: d.d_ = a.d_ / b.d_; break;
+      case expr_op::neg_d: d.d_ = -a.d_; break;
+
+      case expr_op::lt_i: d.i_ = a.i_ < b.i_; break;
+      case expr_op::le_i: d.i_ = a.i_ <= b.i_; break;
+      case expr_op::eq_i: d.i_ = a.i_ == b.i_; break;
+      case expr_op::ne_i: d.i_ = a.i_ != b.i_; break;
+      case expr_op::lt_u: d.i_ = a.u_ < b.u_; break;
+      case expr_op::le_u: d.i_ = a.u_ <= b.u_; break;
+
+      case expr_op::lt_d: d.i_ = a.d_ < b.d_; break;
+      case expr_op::le_d: d.i_ = a.d_ <= b.d_; break;
+      case expr_op::eq_d: d.i_ = a.d_ == b.d_; break;
+      case expr_op::ne_d: d.i_ = a.d_ != b.d_; break;
+
+      case expr_op::not_b: d.i_ = !a.i_; break;
+      case expr_op::jz: if (!a.i_) pc = in.idx_; break;
+      case expr_op::jnz: if (a.i_) pc = in.idx_; break;
+      }
+    }
+
+    return _r[0];
+  }
+
+  std::vector<expr_insn> code_;
+  std::vector<prop_path> paths_;
+  std::vector<call> calls_;
+  size_t tmp_cnt_ = 0;
+  bool mutating_ = false;
+  scalar_kind kind_ = scalar_kind::none;
+  std::string error_;
+};
+
+// recursive descent straight to bytecode, operands live in a stack of registers
+template <typename _Cls>
+class expr_compiler
+{
+public:
+  expr_compiler(std::string_view _text, std::string_view _root) : text_(_text), root_(_root) {}
+
+  expr<_Cls> compile()
+  {
+    operand res;
+    if (parse_or(res))
+    {
+      skip_space();
+      if (!text_.empty())
+        fail("unexpected '" + std::string(text_.substr(0, 1)) + "'");
+    }
+
+    if (!res_.error_.empty())
+    {
+      expr<_Cls> err;
+      err.error_ = std::move(res_.error_);
+      return err;
+    }
+
+    res_.kind_ = res.kind_;
+    return std::move(res_);
+  }
+
+private:
+  struct operand
+  {
+    scalar_kind kind_ = scalar_kind::none;
+    uint8_t reg_ = 0;
+  };
+
+  struct obj_operand
+  {
+    uint8_t reg_ = 0;
+    const field_info *info_ = nullptr;
+    bool con_ = false;
+  };
+
+  bool fail(const std::string &_msg)
+  {
+    if (res_.error_.empty())
+      res_.error_ = _msg;
+
+    return false;
+  }
+
+  void skip_space()
+  {
+    while (!text_.empty() && isspace((unsigned char)text_.front()))
+      text_.remove_prefix(1);
+  }
+
+  bool peek(std::string_view _tok)
+  {
+    skip_space();
+    return text_.substr(0, _tok.size()) == _tok;
+  }
+
+  bool accept(std::string_view _tok)
+  {
+    if (!peek(_tok))
+      return false;
+
+    text_.remove_prefix(_tok.size());
+    return true;
+  }
+
+  bool expect(std::string_view _tok)
+  {
+    return accept(_tok) || fail("expected '" + std::string(_tok) + "'");
+  }
+
+  std::string_view ident()
+  {
+    skip_space();
+
+    size_t n = 0;
+    if (!text_.empty() && (isalpha((unsigned char)text_.front()) || text_.front() == '_'))
+    {
+      while (n < text_.size() && (isalnum((unsigned char)text_[n]) || text_[n] == '_'))
+        ++n;
+    }
+
+    auto res = text_.substr(0, n);
+    text_.remove_prefix(n);
+    return res;
+  }
+
+  size_t emit(expr_insn _in)
+  {
+    res_.code_.push_back(_in);
+    return res_.code_.size() - 1;
+  }
+
+  bool alloc(operand &_op)
+  {
+    if (next_reg_ >= expr_max_regs)
+      return fail("expression too complex");
+
+    _op.reg_ = (uint8_t)next_reg_++;
+    return true;
+  }
+
+  bool alloc_obj(obj_operand &_op)
+  {
+    if (next_obj_ >= expr_max_obj_regs)
+      return fail("member chain too long");
+
+    _op.reg_ = (uint8_t)next_obj_++;
+    return true;
+  }
+
+  void to_float(operand &_op)
+  {
+    if (_op.kind_ == scalar_kind::unsigned_integer)
+      emit({ expr_op::u2d, _op.reg_, _op.reg_ });
+    else if (_op.kind_ != scalar_kind::floating)
+      emit({ expr_op::i2d, _op.reg_, _op.reg_ });
+
+    _op.kind_ = scalar_kind::floating;
+  }
+
+  void to_bool(operand &_op)
+  {
+    if (_op.kind_ == scalar_kind::floating)
+      emit({ expr_op::d2b, _op.reg_, _op.reg_ });
+    else if (_op.kind_ == scalar_kind::integer || _op.kind_ == scalar_kind::unsigned_integer)
+      emit({ expr_op::i2b, _op.reg_, _op.reg_ });
+
+    _op.kind_ = scalar_kind::boolean;
+  }
+
+  static bool is_unsigned(const operand &_lhs, const operand &_rhs)
+  {
+    return _lhs.kind_ == scalar_kind::unsigned_integer || _rhs.kind_ == scalar_kind::unsigned_integer;
+  }
+
+  // the right operand always sits in the register after the left one and is freed here
+  void release(operand &_lhs)
+  {
+    next_reg_ = _lhs.reg_ + 1;
+  }
+
+  bool parse_or(operand &_op)
+  {
+    if (!parse_and(_op))
+      return false;
+
+    while (accept("||"))
+    {
+      to_bool(_op);
+      auto jmp = emit({ expr_op::jnz, 0, _op.reg_ });
+
+      operand rhs;
+      if (!parse_and(rhs))
+        return false;
+
+      to_bool(rhs);
+      emit({ expr_op::mov, _op.reg_, rhs.reg_ });
+      release(_op);
+      res_.code_[jmp].idx_ = res_.code_.size();
+    }
+
+    return true;
+  }
+
+  bool parse_and(operand &_op)
+  {
+    if (!parse_cmp(_op))
+      return false;
+
+    while (accept("&&"))
+    {
+      to_bool(_op);
+      auto jmp = emit({ expr_op::jz, 0, _op.reg_ });
+
+      operand rhs;
+      if (!parse_cmp(rhs))
+        return false;
+
+      to_bool(rhs);
+      emit({ expr_op::mov, _op.reg_, rhs.reg_ });
+      release(_op);
+      res_.code_[jmp].idx_ = res_.code_.size();
+    }
+
+    return true;
+  }
+
+  bool parse_cmp(operand &_op)
+  {
+    if (!parse_add(_op))
+      return false;
+
+    // > and >= are < and <= with the operands swapped
+    static const struct { std::string_view tok_; expr_op int_op_, uint_op_, float_op_; bool swap_; } ops[] = {
+      { "==", expr_op::eq_i, expr_op::eq_i, expr_op::eq_d, false }, { "!=", expr_op::ne_i, expr_op::ne_i, expr_op::ne_d, false },
+      { "<=", expr_op::le_i, expr_op::le_u, expr_op::le_d, false }, { ">=", expr_op::le_i, expr_op::le_u, expr_op::le_d, true },
+      { "<", expr_op::lt_i, expr_op::lt_u, expr_op::lt_d, false }, { ">", expr_op::lt_i, expr_op::lt_u, expr_op::lt_d, true }
+    };
+
+    for (auto &o : ops)
+    {
+      if (!accept(o.tok_))
+        continue;
+
+      operand rhs;
+      if (!parse_add(rhs))
+        return false;
+
+      bool flt = _op.kind_ == scalar_kind::floating || rhs.kind_ == scalar_kind::floating;
+      if (flt)
+      {
+        to_float(_op);
+        to_float(rhs);
+      }
+
+      auto a = o.swap_ ? rhs.reg_ : _op.reg_, b = o.swap_ ? _op.reg_ : rhs.reg_;
+      emit({ flt ? o.float_op_ : is_unsigned(_op, rhs) ? o.uint_op_ : o.int_op_, _op.reg_, a, b });
+
+      _op.kind_ = scalar_kind::boolean;
+      release(_op);
+      break;
+    }
+
+    return true;
+  }
+
+  bool arith(operand &_op, operand &_rhs, expr_op _int_op, expr_op _uint_op, expr_op _float_op)
+  {
+    bool flt = _op.kind_ == scalar_kind::floating || _rhs.kind_ == scalar_kind::floating;
+    if (flt)
+    {
+      if (_float_op == _int_op)
+        return fail("'%' needs integer operands");
+
+      to_float(_op);
+      to_float(_rhs);
+    }
+
+    bool uns = !flt && is_unsigned(_op, _rhs);
+    emit({ flt ? _float_op : uns ? _uint_op : _int_op, _op.reg_, _op.reg_, _rhs.reg_ });
+
+    _op.kind_ = flt ? scalar_kind::floating : uns ? scalar_kind::unsigned_integer : scalar_kind::integer;
+    release(_op);
+    return true;
+  }
+
+  bool parse_add(operand &_op)
+  {
+    if (!parse_mul(_op))
+      return false;
+
+    while (true)
+    {
+      bool add = accept("+");
+      if (!add && !accept("-"))
+        return true;
+
+      operand rhs;
+      if (!parse_mul(rhs))
+        return false;
+
+      // two's complement addition is the same for signed and unsigned
+      auto int_op = add ? expr_op::add_i : expr_op::sub_i;
+      if (!arith(_op, rhs, int_op, int_op, add ? expr_op::add_d : expr_op::sub_d))
+        return false;
+    }
+  }
+
+  bool parse_mul(operand &_op)
+  {
+    if (!parse_unary(_op))
+      return false;
+
+    while (true)
+    {
+      expr_op int_op, uint_op, float_op;
+      if (accept("*"))
+        int_op = uint_op = expr_op::mul_i, float_op = expr_op::mul_d;
+      else if (accept("/"))
+        int_op = expr_op::div_i, uint_op = expr_op::div_u, float_op = expr_op::div_d;
+      else if (accept("%"))
+        int_op = float_op = expr_op::mod_i, uint_op = expr_op::mod_u;
+      else
+        return true;
+
+      operand rhs;
+      if (!parse_unary(rhs))
+        return false;
+
+      if (!arith(_op, rhs, int_op, uint_op, float_op))
+        return false;
+    }
+  }
+
+  bool parse_unary(operand &_op)
+  {
+    // != is a binary operator, not a negation
+    if (!peek("!=") && accept("!"))
+    {
+      if (!parse_unary(_op))
+        return false;
+
+      to_bool(_op);
+      emit({ expr_op::not_b, _op.reg_, _op.reg_ });
+      return true;
+    }
+
+    if (accept("-"))
+    {
+      if (!parse_unary(_op))
+        return false;
+
+      if (_op.kind_ == scalar_kind::floating)
+        emit({ expr_op::neg_d, _op.reg_, _op.reg_ });
+      else
+      {
+        emit({ expr_op::neg_i, _op.reg_, _op.reg_ });
+        if (_op.kind_ != scalar_kind::unsigned_integer)
+          _op.kind_ = scalar_kind::integer;
+      }
+
+      return true;
+    }
+
+    return parse_primary(_op);
+  }
+
+  bool parse_number(operand &_op)
+  {
+    size_t n = 0;
+    bool flt = false;
+    while (n < text_.size())
+    {
+      auto c = text_[n];
+      if (c == '.' || c == 'e' || c == 'E')
+        flt = true;
+      else if ((c == '+' || c == '-') && (text_[n - 1] == 'e' || text_[n - 1] == 'E'))
+        ;
+      else if (!isdigit((unsigned char)c))
+        break;
+
+      ++n;
+    }
+
+    std::string num(text_.substr(0, n));
+    text_.remove_prefix(n);
+
+    // an integer past INT64_MAX is unsigned, one past UINT64_MAX or a float past DBL_MAX is an error
+    char *end = nullptr;
+    errno = 0;
+    expr_insn in{ expr_op::imm, _op.reg_ };
+    if (flt)
+      in.imm_.d_ = strtod(num.c_str(), &end);
+    else
+      in.imm_.u_ = strtoull(num.c_str(), &end, 10);
+
+    if (end != num.c_str() + num.size())
+      return fail("bad number '" + num + "'");
+
+    if (flt ? std::isinf(in.imm_.d_) : errno == ERANGE)
+      return fail("number out of range '" + num + "'");
+
+    emit(in);
+    _op.kind_ = flt ? scalar_kind::floating : in.imm_.u_ > INT64_MAX ? scalar_kind::unsigned_integer : scalar_kind::integer;
+    return true;
+  }
+
+  bool parse_primary(operand &_op)
+  {
+    skip_space();
+    if (text_.empty())
+      return fail("unexpected end of expression");
+
+    if (accept("("))
+      return parse_or(_op) && expect(")");
+
+    if (!alloc(_op))
+      return false;
+
+    if (isdigit((unsigned char)text_.front()) || text_.front() == '.')
+      return parse_number(_op);
+
+    auto name = ident();
+    if (name == "true" || name == "false")
+    {
+      expr_insn in{ expr_op::imm, _op.reg_ };
+      in.imm_.i_ = name == "true";
+      emit(in);
+
+      _op.kind_ = scalar_kind::boolean;
+      return true;
+    }
+
+    if (name.empty() || name != root_)
+      return fail("unknown identifier '" + std::string(name.empty() ? text_.substr(0, 1) : name) + "'");
+
+    auto obj_base = next_obj_;
+    obj_operand obj{ 0, &field_info::of<_Cls>(), false };
+    if (!parse_chain(obj, _op))
+      return false;
+
+    next_obj_ = obj_base;
+    return true;
+  }
+
+  // members after the root, property steps are gathered into one path until a call or the end
+  bool parse_chain(obj_operand &_obj, operand &_op)
+  {
+    std::string path;
+    while (true)
+    {
+      if (accept("["))
+      {
+        skip_space();
+
+        size_t n = 0;
+        while (n < text_.size() && isdigit((unsigned char)text_[n]))
+          ++n;
+
+        if (!n || path.empty())
+          return fail("bad index");
+
+        path += "[" + std::string(text_.substr(0, n)) + "]";
+        text_.remove_prefix(n);
+
+        if (!expect("]"))
+          return false;
+      }
+      else if (accept("."))
+      {
+        auto name = ident();
+        if (name.empty())
+          return fail("expected a member name");
+
+        if (!accept("("))
+        {
+          path += (path.empty() ? "" : ".") + std::string(name);
+          continue;
+        }
+
+        if (!expect(")") || !load_obj(_obj, path))
+          return false;
+
+        path.clear();
+
+        const field_info *ret = nullptr;
+        if (!add_call(_obj, _op, name, ret))
+          return false;
+
+        if (ret->load_scalar_)
+        {
+          _op.kind_ = ret->scalar_;
+
+          if (peek(".") || peek("["))
+            return fail("'" + std::string(name) + "()' gives an arithmetic value, it has no members");
+
+          return true;
+        }
+
+        _obj.info_ = ret;
+        _obj.con_ = ret->desc_->get_cv_qualifier().con_;
+      }
+      else
+        break;
+    }
+
+    if (path.empty())
+      return fail("an object isn't an arithmetic value");
+
+    auto p = prop_path::compile(*_obj.info_, path);
+    if (p.is_null())
+      return fail("unknown member path '" + path + "'");
+
+    auto &leaf = p.get_leaf();
+    if (!leaf.load_scalar_)
+      return fail("'" + path + "' isn't an arithmetic value");
+
+    expr_insn in{ p.is_flat() ? expr_op::load_off : expr_op::load_path, _op.reg_, _obj.reg_ };
+    in.idx_ = p.is_flat() ? p.get_offset() : res_.paths_.size();
+    in.load_ = leaf.load_scalar_;
+    emit(in);
+
+    if (!p.is_flat())
+      res_.paths_.push_back(std::move(p));
+
+    _op.kind_ = leaf.scalar_;
+    return true;
+  }
+
+  // moves _obj to the end of _path
+  bool load_obj(obj_operand &_obj, const std::string &_path)
+  {
+    if (_path.empty())
+      return true;
+
+    auto p = prop_path::compile(*_obj.info_, _path);
+    if (p.is_null())
+      return fail("unknown member path '" + _path + "'");
+
+    obj_operand next;
+    if (!alloc_obj(next))
+      return false;
+
+    expr_insn in{ p.is_flat() ? expr_op::obj_off : expr_op::obj_path, next.reg_, _obj.reg_ };
+    in.idx_ = p.is_flat() ? p.get_offset() : res_.paths_.size();
+    emit(in);
+
+    next.info_ = &p.get_leaf();
+    next.con_ = _obj.con_ || p.is_const() || next.info_->desc_->get_cv_qualifier().con_;
+
+    if (!p.is_flat())
+      res_.paths_.push_back(std::move(p));
+
+    _obj = next;
+    return true;
+  }
+
+  // emits a call_scalar into _op if the call returns an arithmetic value,
+  // otherwise a call_obj leaving the returned object in a new object register
+  bool add_call(obj_operand &_obj, operand &_op, std::string_view _name, const field_info *&_ret)
+  {
+    auto desc = _obj.info_->desc_;
+    if (_obj.con_ && !desc->get_cv_qualifier().con_)
+      return fail("'" + std::string(_name) + "()' called through a const member");
+
+    auto m = _obj.info_->child_method_ ? _obj.info_->child_method_(_name) : nullptr;
+    if (!m || m->is_null())
+      return fail("unknown method '" + std::string(_name) + "'");
+
+    auto fn = m->find_overload(&desc, 1);
+    if (!fn)
+      return fail("no overload of '" + std::string(_name) + "' takes no arguments");
+
+    _ret = fn->get_ret_info();
+    if (!_ret)
+      return fail("'" + std::string(_name) + "()' returns void");
+
+    if (res_.calls_.size() >= expr_max_calls)
+      return fail("too many calls");
+
+    if (!fn->get_arg_descs()[0]->get_cv_qualifier().con_)
+      res_.mutating_ = true;
+
+    if (_ret->load_scalar_)
+    {
+      expr_insn in{ expr_op::call_scalar, _op.reg_, _obj.reg_ };
+      in.idx_ = res_.calls_.size();
+      emit(in);
+    }
+    else
+    {
+      obj_operand next;
+      if (!alloc_obj(next))
+        return false;
+
+      expr_insn in{ expr_op::call_obj, next.reg_, _obj.reg_, (uint8_t)res_.tmp_cnt_++ };
+      in.idx_ = res_.calls_.size();
+      emit(in);
+
+      _obj.reg_ = next.reg_;
+    }
+
+    res_.calls_.push_back({ fn, desc });
+    return true;
+  }
+
+  std::string_view text_;
+  std::string_view root_;
+  size_t next_reg_ = 0;
+  size_t next_obj_ = 1;
+  expr<_Cls> res_;
+};
+
+// a malformed expression gives a null expr, see expr::get_error
+template <typename _Cls>
+expr<_Cls> compile_expr(std::string_view _text, std::string_view _root = "obj")
+{
+  return expr_compiler<_Cls>(_text, _root).compile();
+}
@@ -1,6 +1,11 @@
 #include <cpptr.h>
 #include <gtest/gtest.h>
 
+#include <cmath>
+#include <functional>
+#include <list>
+#include <set>
+
 struct data
 {
   bool operator==(const data &_other) const
@@ -11,6 +16,11 @@ struct data
   int i_;
 };
 
+TR_INIT(data)
+{
+  TR_PROPERTY(i_);
+}
+
 struct st
 {
   void set_a(data _a) { a_ = _a; }
@@ -102,7 +112,7 @@ protected:
 
 TEST_F(Cpptr, Method)
 {
-  /*set_a_(s_, i_);
+  set_a_(s_, i_);
   EXPECT_EQ(s_.a_, i_);
   EXPECT_EQ(s_.a_, get_a_(s_).get<data>());
 
@@ -134,7 +144,7 @@ TEST_F(Cpptr, Method)
   EXPECT_DEATH(get_b_(s_).get<data &&>(), "");
 
   EXPECT_EQ(c_s_.a_, get_a_c_(c_s_).get<data>());
-  EXPECT_DEATH(get_a_(c_s_).get<data>(), "");*/
+  EXPECT_DEATH(get_a_(c_s_).get<data>(), "");
 }
 
 TEST_F(Cpptr, Property)
@@ -167,3 +177,790 @@ TEST_F(Cpptr, Property)
   EXPECT_DEATH(a_.get<data&>(c_s_), "");
   EXPECT_DEATH(c_a_.get<data&>(s_), "");
 }
+
+
+static int lazy_init_cnt = 0;
+
+struct lazy
+{
+  int v_;
+};
+
+TR_INIT(lazy)
+{
+  ++lazy_init_cnt;
+  add_property("v_", &TR_TY::v_);
+}
+
+TEST(TrInfo, Lazy)
+{
+  EXPECT_EQ(lazy_init_cnt, 0);
+
+  preload<lazy>();
+  EXPECT_EQ(lazy_init_cnt, 1);
+
+  lazy l{ 1 };
+  EXPECT_EQ(tr_data<lazy>.get_property("v_").get<int>(l), 1);
+  EXPECT_EQ(&tr_data<lazy>->get_property("v_"), &tr_data<lazy>.get_property("v_"));
+  EXPECT_TRUE(tr_data<lazy>.get_property("w_").is_null());
+  EXPECT_EQ(lazy_init_cnt, 1);
+}
+
+TEST(TrInfo, Symbol)
+{
+  auto &pool = symbol_pool::instance();
+  auto &info = tr_data<st>.get();
+
+  auto sym = pool.find("a_");
+  EXPECT_NE(sym, null_symbol);
+  EXPECT_EQ(pool.intern("a_"), sym);
+  EXPECT_EQ(pool.name(sym), "a_");
+  EXPECT_EQ(pool.find("no_such_member"), null_symbol);
+
+  EXPECT_EQ(&info.get_property(sym), &info.get_property("a_"));
+  EXPECT_EQ(info.get_property(sym).get_symbol(), sym);
+  EXPECT_TRUE(info.get_method(sym).is_null());
+  EXPECT_TRUE(info.get_property("no_such_member").is_null());
+  EXPECT_TRUE(info.get_property(pool.find("set_a")).is_null());
+
+  auto &names = info.get_property_names();
+  EXPECT_EQ(&names, &info.get_property_names());
+  ASSERT_EQ(names.size(), 7u);
+  EXPECT_EQ(names[0], "a_");
+  EXPECT_EQ(names[6], "c_a_");
+  EXPECT_EQ(names[0].data(), pool.name(sym).data());
+
+  EXPECT_EQ(info.get_method_names().size(), 13u);
+
+  // longer than a pool block
+  std::string big(5000, 'x');
+  auto big_sym = pool.intern(big);
+  auto small_sym = pool.intern("after_big_name");
+  EXPECT_EQ(pool.name(big_sym), big);
+  EXPECT_EQ(pool.name(small_sym), "after_big_name");
+  EXPECT_EQ(pool.name(sym), "a_");
+}
+
+struct overload
+{
+  int get(int _v) { return _v + 1; }
+  int get(int _v) const { return _v + 2; }
+  int get(double _v) { return (int)_v + 3; }
+  int get(int _v, int _w) { return _v + _w; }
+
+  int only(int _v) { return _v; }
+};
+
+TR_INIT(overload)
+{
+  TR_OVERLOAD(get, int(int));
+  TR_OVERLOAD(get, int(int) const);
+  TR_OVERLOAD(get, int(double));
+  TR_OVERLOAD(get, int(int, int));
+
+  TR_METHOD(only);
+}
+
+struct twice
+{
+  int get(int _v) { return _v; }
+};
+
+TR_INIT(twice)
+{
+  TR_METHOD(get);
+  TR_OVERLOAD(get, int(int));
+}
+
+TEST(TrInfo, Overload)
+{
+  auto &get = tr_data<overload>.get_method("get");
+  EXPECT_EQ(get.get_overload_cnt(), 4u);
+  EXPECT_EQ(tr_data<overload>.get_method_names().size(), 2u);
+  EXPECT_EQ(tr_data<overload>.get_method("only").get_overload_cnt(), 1u);
+
+  overload o;
+  const overload c_o;
+  int i = 1;
+  double d = 1.0;
+
+  for (int n = 0; n < 2; ++n)
+  {
+    EXPECT_EQ(get(o, i).get<int>(), 2);
+    EXPECT_EQ(get(c_o, i).get<int>(), 3);
+    EXPECT_EQ(get(o, d).get<int>(), 4);
+    EXPECT_EQ(get(o, i, i).get<int>(), 2);
+  }
+
+  EXPECT_EQ(tr_data<overload>.get_method("only")(o, i).get<int>(), 1);
+  EXPECT_DEATH(get(c_o, d), "");
+  EXPECT_DEATH(preload<twice>(), "");
+}
+
+struct statics
+{
+  static int make(int _v) { return _v * 2; }
+
+  static inline int cnt_ = 1;
+  static inline const int c_cnt_ = 2;
+};
+
+TR_INIT(statics)
+{
+  TR_METHOD(make);
+  TR_PROPERTY(cnt_);
+  TR_PROPERTY(c_cnt_);
+}
+
+static int add(int _a, int _b) { return _a + _b; }
+static double add(double _a, double _b) { return _a + _b; }
+static int answer() { return 42; }
+
+static int tick_rate = 30;
+
+struct global_ns {};
+
+TR_INIT(global_ns)
+{
+  TR_FUNCTION_OVERLOAD(add, int(int, int));
+  TR_FUNCTION_OVERLOAD(add, double(double, double));
+  TR_FUNCTION(answer);
+  TR_VARIABLE(tick_rate);
+}
+
+TEST(TrInfo, Static)
+{
+  int i = 3;
+  EXPECT_EQ(tr_data<statics>.get_method("make")(i).get<int>(), 6);
+
+  auto &cnt = tr_data<statics>.get_property("cnt_");
+  EXPECT_EQ(cnt.get<int>(), 1);
+  cnt.set(i);
+  EXPECT_EQ(statics::cnt_, 3);
+  EXPECT_EQ(cnt.get<int &>(), 3);
+
+  auto &c_cnt = tr_data<statics>.get_property("c_cnt_");
+  EXPECT_EQ(c_cnt.get<const int &>(), 2);
+  EXPECT_DEATH(c_cnt.set(i), "");
+
+  statics s;
+  EXPECT_DEATH(cnt.get<int>(s), "");
+}
+
+TEST(TrInfo, Global)
+{
+  int a = 1, b = 2;
+  double c = 1.5, d = 2.5;
+  auto &add = tr_data<global_ns>.get_method("add");
+  EXPECT_EQ(add(a, b).get<int>(), 3);
+  EXPECT_EQ(add(c, d).get<double>(), 4.0);
+  EXPECT_EQ(tr_data<global_ns>.get_method("answer")().get<int>(), 42);
+
+  auto &rate = tr_data<global_ns>.get_property("tick_rate");
+  int r = 60;
+  rate.set(r);
+  EXPECT_EQ(tick_rate, 60);
+  EXPECT_EQ(rate.get<int>(), 60);
+}
+
+struct tracked
+{
+  void set_d(double _d) { d_ = _d; }
+
+  int i_ = 0;
+  double d_ = 0;
+  data a_ = {};
+
+  dirty_set dirty_;
+};
+
+TR_INIT(tracked)
+{
+  TR_SETTER(set_d, d_);
+  TR_PROPERTY(i_);
+  TR_DIRTY(dirty_);
+  TR_PROPERTY(d_);
+  TR_PROPERTY(a_);
+}
+
+TEST(TrInfo, Dirty)
+{
+  std::vector<std::vector<size_t>> batches;
+  tr_data<tracked>->add_observer([&](tracked &, const std::vector<size_t> &_slots) { batches.push_back(_slots); });
+
+  tracked t;
+  auto &i = tr_data<tracked>.get_property("i_");
+  auto &a = tr_data<tracked>.get_property("a_");
+  EXPECT_EQ(a.get_slot(), 2u);
+
+  EXPECT_FALSE(t.dirty_.any());
+  i.set(t, 1);
+  i.set(t, 2);
+  a.set(t, data{ 3 });
+  EXPECT_TRUE(t.dirty_.test(0));
+  EXPECT_FALSE(t.dirty_.test(1));
+  EXPECT_TRUE(t.dirty_.test(2));
+
+  tr_data<tracked>->flush(t);
+  tr_data<tracked>->flush(t);
+  ASSERT_EQ(batches.size(), 1u);
+  EXPECT_EQ(batches[0], (std::vector<size_t>{ 0, 2 }));
+  EXPECT_FALSE(t.dirty_.any());
+
+  double d = 1.5;
+  tr_data<tracked>.get_method("set_d")(t, d);
+  EXPECT_EQ(t.d_, 1.5);
+  EXPECT_TRUE(t.dirty_.test(1));
+
+  // an observer may register another one while being notified
+  size_t nested = 0;
+  tr_data<tracked>->add_observer([&](tracked &, const std::vector<size_t> &) {
+    if (!nested++)
+      tr_data<tracked>->add_observer([](tracked &, const std::vector<size_t> &) {});
+  });
+  tr_data<tracked>->flush(t);
+  ASSERT_EQ(batches.size(), 2u);
+  EXPECT_EQ(batches[1], (std::vector<size_t>{ 1 }));
+  EXPECT_EQ(nested, 1u);
+
+  dirty_set big;
+  big.mark(3);
+  big.mark(130);
+  std::vector<size_t> slots;
+  big.for_each([&](size_t _slot) { slots.push_back(_slot); });
+  EXPECT_EQ(slots, (std::vector<size_t>{ 3, 130 }));
+}
+
+struct snapshot
+{
+  int x_ = 0;
+  int y_ = 0;
+  int z_ = 0;
+  double w_ = 0;
+  std::string name_;
+  std::vector<int> items_;
+  const int id_ = 7;
+};
+
+TR_INIT(snapshot)
+{
+  TR_PROPERTY(name_);
+  TR_PROPERTY(z_);
+  TR_PROPERTY(x_);
+  TR_PROPERTY(y_);
+  TR_PROPERTY(w_);
+  TR_PROPERTY(items_);
+  TR_PROPERTY(id_);
+}
+
+TEST(TrInfo, Patch)
+{
+  snapshot a, b;
+  EXPECT_TRUE(diff(a, b).empty());
+
+  b.x_ = 1;
+  b.y_ = 2;
+  b.w_ = 3.5;
+  b.name_ = "b";
+
+  auto p = diff(a, b);
+  EXPECT_FALSE(p.empty());
+  EXPECT_EQ(p.get_obj_cnt(), 1u);
+
+  // x_ and y_ are adjacent, so they share one run
+  EXPECT_LT(p.get_bytes().size(), 2 * sizeof(int) + sizeof(double) + 8);
+
+  apply_patch(a, p);
+  EXPECT_EQ(a.x_, 1);
+  EXPECT_EQ(a.y_, 2);
+  EXPECT_EQ(a.z_, 0);
+  EXPECT_EQ(a.w_, 3.5);
+  EXPECT_EQ(a.name_, "b");
+  EXPECT_TRUE(a.items_.empty());
+  EXPECT_TRUE(diff(a, b).empty());
+
+  b.items_ = { 1, 2, 3 };
+  b.z_ = 4;
+  tr_data<snapshot>->apply_patch(a, tr_data<snapshot>->diff(a, b));
+  EXPECT_EQ(a.items_, b.items_);
+  EXPECT_EQ(a.z_, 4);
+}
+
+TEST(TrInfo, PatchDirty)
+{
+  tracked a, b;
+  b.d_ = 1.5;
+  b.a_ = { 2 };
+
+  apply_patch(a, diff(a, b));
+  EXPECT_EQ(a.d_, 1.5);
+  EXPECT_EQ(a.a_.i_, 2);
+  EXPECT_FALSE(a.dirty_.test(0));
+  EXPECT_TRUE(a.dirty_.test(1));
+  EXPECT_TRUE(a.dirty_.test(2));
+}
+
+struct inner
+{
+  std::string tag_;
+  int v_ = 0;
+};
+
+TR_INIT(inner)
+{
+  TR_PROPERTY(tag_);
+  TR_PROPERTY(v_);
+}
+
+struct outer
+{
+  int a_ = 0;
+  int b_ = 0;
+  inner in_;
+  std::vector<int> items_;
+  int unregistered_ = 0;
+};
+
+TR_INIT(outer)
+{
+  TR_PROPERTY(a_);
+  TR_PROPERTY(b_);
+  TR_PROPERTY(in_);
+  TR_PROPERTY(items_);
+}
+
+TEST(TrInfo, Reflect)
+{
+  outer a;
+  a.a_ = 1;
+  a.in_.tag_ = "x";
+  a.items_ = { 1, 2 };
+  a.unregistered_ = 5;
+
+  auto b = reflect_clone(a);
+  EXPECT_EQ(b.a_, 1);
+  EXPECT_EQ(b.in_.tag_, "x");
+  EXPECT_EQ(b.items_, a.items_);
+  EXPECT_EQ(b.unregistered_, 0);
+
+  EXPECT_TRUE(reflect_equal(a, b));
+  EXPECT_EQ(reflect_hash(a), reflect_hash(b));
+
+  b.in_.v_ = 3;
+  EXPECT_FALSE(reflect_equal(a, b));
+  EXPECT_NE(reflect_hash(a), reflect_hash(b));
+
+  snapshot s, t;
+  EXPECT_TRUE(reflect_equal(s, t));
+  EXPECT_EQ(reflect_hash(s), reflect_hash(t));
+
+  std::unordered_map<outer, int, reflect_hasher<outer>, reflect_equal_to<outer>> m;
+  m[a] = 1;
+  m[b] = 2;
+  EXPECT_EQ(m.size(), 2u);
+  EXPECT_EQ(m[reflect_clone(a)], 1);
+
+  char buf[100] = {};
+  EXPECT_EQ(hash_bytes(buf, 100, 0), hash_bytes(buf, 100, 0));
+  EXPECT_NE(hash_bytes(buf, 100, 0), hash_bytes(buf, 99, 0));
+}
+
+TEST(TrInfo, PatchWire)
+{
+  snapshot a, b;
+  b.x_ = 1;
+  b.w_ = 2.5;
+  b.name_ = "wire";
+  b.items_ = { 4, 5 };
+
+  auto bytes = diff(a, b).encode();
+  ASSERT_FALSE(bytes.empty());
+
+  auto p = patch::decode(bytes.data(), bytes.size());
+  ASSERT_FALSE(p.is_null());
+  EXPECT_EQ(p.get_obj_cnt(), 2u);
+  EXPECT_TRUE(apply_patch(a, p));
+  EXPECT_EQ(a.x_, 1);
+  EXPECT_EQ(a.w_, 2.5);
+  EXPECT_EQ(a.name_, "wire");
+  EXPECT_EQ(a.items_, b.items_);
+  EXPECT_TRUE(diff(a, b).empty());
+
+  // nested reflected types go through their own fields
+  outer o, q;
+  q.in_.tag_ = "in";
+  q.in_.v_ = 3;
+  bytes = diff(o, q).encode();
+  EXPECT_TRUE(apply_patch(o, patch::decode(bytes.data(), bytes.size())));
+  EXPECT_EQ(o.in_.tag_, "in");
+  EXPECT_EQ(o.in_.v_, 3);
+
+  snapshot c;
+  for (size_t n = 0; n < bytes.size(); ++n)
+    EXPECT_TRUE(patch::decode(bytes.data(), n).is_null());
+
+  // a run has to cover whole writable raw wire fields, the first one ends inside x_,
+  // the second one would write over name_
+  std::vector<uint8_t> bad = { 4, 0, 2, 1, 1, 0 };
+  EXPECT_FALSE(patch::decode(bad.data(), bad.size()).is_null());
+  EXPECT_FALSE(apply_patch(c, patch::decode(bad.data(), bad.size())));
+
+  auto name = (uint8_t)offsetof(snapshot, name_);
+  bad = { 6, name, 4, 1, 1, 1, 1, 0 };
+  EXPECT_FALSE(apply_patch(c, patch::decode(bad.data(), bad.size())));
+
+  // slot 6 is the const id_
+  bad = { 0, 1, 6, 4, 9, 0, 0, 0 };
+  EXPECT_FALSE(apply_patch(c, patch::decode(bad.data(), bad.size())));
+
+  // a string that claims more bytes than it has
+  bad = { 0, 1, 0, 2, 5, 'x' };
+  EXPECT_FALSE(apply_patch(c, patch::decode(bad.data(), bad.size())));
+  EXPECT_TRUE(c.name_.empty());
+
+  EXPECT_FALSE(apply_patch(o, diff(c, b)));
+}
+
+struct padded
+{
+  char c_ = 0;
+  int i_ = 0;
+};
+
+TR_INIT(padded)
+{
+  TR_PROPERTY(c_);
+  TR_PROPERTY(i_);
+}
+
+enum class mode : uint8_t { off, on, auto_ };
+
+template <>
+struct enum_range<mode>
+{
+  static constexpr uint64_t min_ = 0, max_ = 2;
+};
+
+struct wire_probe
+{
+  bool on_ = false;
+  mode m_ = mode::off;
+  int *ptr_ = nullptr;
+  padded pad_;
+  int n_ = 0;
+};
+
+TR_INIT(wire_probe)
+{
+  TR_PROPERTY(on_);
+  TR_PROPERTY(m_);
+  TR_PROPERTY(ptr_);
+  TR_PROPERTY(pad_);
+  TR_PROPERTY(n_);
+}
+
+TEST(TrInfo, PatchWireCheck)
+{
+  wire_probe a, b;
+  auto apply = [&](std::vector<uint8_t> _bytes) { return apply_patch(a, patch::decode(_bytes.data(), _bytes.size())); };
+
+  // bool, enum and pointer fields never take raw runs
+  EXPECT_FALSE(apply({ 3, (uint8_t)offsetof(wire_probe, on_), 1, 0x7f, 0 }));
+  EXPECT_FALSE(apply({ 3, (uint8_t)offsetof(wire_probe, m_), 1, 9, 0 }));
+  EXPECT_FALSE(apply({ 10, (uint8_t)offsetof(wire_probe, ptr_), 8, 0xef, 0xbe, 0xad, 0xde, 0, 0, 0, 0, 0 }));
+
+  // through their codecs, slots in registration order
+  EXPECT_FALSE(apply({ 0, 1, 0, 1, 0x7f }));
+  EXPECT_FALSE(apply({ 0, 1, 1, 1, 5 }));
+  EXPECT_FALSE(apply({ 0, 1, 2, 8, 0xef, 0xbe, 0xad, 0xde, 0, 0, 0, 0 }));
+  EXPECT_FALSE(a.on_);
+  EXPECT_EQ(a.m_, mode::off);
+  EXPECT_EQ(a.ptr_, nullptr);
+
+  EXPECT_TRUE(apply({ 0, 2, 0, 1, 1, 1, 1, 2 }));
+  EXPECT_TRUE(a.on_);
+  EXPECT_EQ(a.m_, mode::auto_);
+
+  // a padded struct goes field by field, its padding stays off the wire
+  memset((void *)&b.pad_, 0xab, sizeof(b.pad_));
+  b.pad_.c_ = 'x';
+  b.pad_.i_ = 1;
+  b.n_ = 2;
+
+  auto p = diff(a, b);
+  EXPECT_EQ(p.get_obj_cnt(), 3u);
+  auto bytes = p.encode();
+  ASSERT_FALSE(bytes.empty());
+  EXPECT_EQ(std::find(bytes.begin(), bytes.end(), 0xab), bytes.end());
+
+  EXPECT_TRUE(apply(bytes));
+  EXPECT_EQ(a.pad_.c_, 'x');
+  EXPECT_EQ(a.pad_.i_, 1);
+  EXPECT_EQ(a.n_, 2);
+  EXPECT_FALSE(a.on_);
+
+  // a changed pointer only lives in this process
+  int i = 0;
+  b.ptr_ = &i;
+  p = diff(a, b);
+  EXPECT_TRUE(p.encode().empty());
+  EXPECT_TRUE(apply_patch(a, p));
+  EXPECT_EQ(a.ptr_, &i);
+}
+
+struct cfg
+{
+  std::string name_;
+  static const cfg defaults_;
+};
+
+const cfg cfg::defaults_ = { "default" };
+
+TR_INIT(cfg)
+{
+  TR_PROPERTY(name_);
+  TR_PROPERTY(defaults_);
+}
+
+static int late_init_cnt = 0;
+
+struct late
+{
+  std::string s_;
+  int v_ = 0;
+};
+
+TR_INIT(late)
+{
+  ++late_init_cnt;
+  TR_PROPERTY(s_);
+  TR_PROPERTY(v_);
+}
+
+struct pt
+{
+  int x_ = 0;
+  int cache_ = 0;
+};
+
+TR_INIT(pt)
+{
+  TR_PROPERTY(x_);
+}
+
+struct holder
+{
+  pt p_;
+  late l_;
+  long double v_ = 0;
+  std::vector<double> ds_;
+  std::function<void()> fn_;
+};
+
+TR_INIT(holder)
+{
+  TR_PROPERTY(p_);
+  TR_PROPERTY(l_);
+  TR_PROPERTY(v_);
+  TR_PROPERTY(ds_);
+  TR_PROPERTY(fn_);
+}
+
+TEST(TrInfo, ReflectEquivalence)
+{
+  // a static member of the type's own type doesn't re-enter its registration
+  EXPECT_EQ(tr_data<cfg>.get_property("defaults_").get<const cfg &>().name_, "default");
+
+  // nested types register on first comparison, not with the outer type
+  preload<holder>();
+  EXPECT_EQ(late_init_cnt, 0);
+
+  holder a, b;
+  b.fn_ = []() {};
+  a.p_.cache_ = 1;
+  a.ds_ = b.ds_ = { std::nan(""), -0.0 };
+
+  // uncompared members and fields without operator== don't matter, the copies need not share padding
+  memset((void *)&a.v_, 0xff, sizeof(a.v_));
+  a.v_ = 1.5;
+  b.v_ = 1.5;
+
+  EXPECT_TRUE(reflect_equal(a, a));
+  EXPECT_TRUE(reflect_equal(a, b));
+  EXPECT_EQ(reflect_hash(a), reflect_hash(b));
+  EXPECT_EQ(late_init_cnt, 1);
+
+  b.ds_[1] = 0.0;
+  EXPECT_FALSE(reflect_equal(a, b));
+
+  std::unordered_map<holder, int, reflect_hasher<holder>, reflect_equal_to<holder>> m;
+  m[a] = 1;
+  EXPECT_EQ(m.count(a), 1u);
+
+  // a field that can't be compared is always sent
+  EXPECT_EQ(diff(a, a).get_obj_cnt(), 1u);
+}
+
+struct node
+{
+  int id_ = 0;
+  st s_;
+  int grid_[4] = {};
+  inner ins_[2];
+  std::vector<inner> items_;
+  std::vector<bool> flags_;
+};
+
+TR_INIT(node)
+{
+  TR_PROPERTY(id_);
+  TR_PROPERTY(s_);
+  TR_PROPERTY(grid_);
+  TR_PROPERTY(ins_);
+  TR_PROPERTY(items_);
+  TR_PROPERTY(flags_);
+}
+
+TEST(TrInfo, Path)
+{
+  node n;
+  n.s_.a_.i_ = 5;
+  n.grid_[2] = 6;
+  n.ins_[1].v_ = 7;
+  n.items_ = { { "a", 8 }, { "b", 9 } };
+
+  auto ai = compile_path<node>("s_.a_.i_");
+  ASSERT_FALSE(ai.is_null());
+  EXPECT_TRUE(ai.is_flat());
+  EXPECT_EQ(ai.get<int>(n), 5);
+  ai.get<int>(n) = 10;
+  EXPECT_EQ(n.s_.a_.i_, 10);
+
+  const node &c_n = n;
+  EXPECT_EQ(ai.get<const int>(c_n), 10);
+
+  auto ca = tr_data<node>->compile_path("s_.c_a_.i_");
+  EXPECT_EQ(ca.get<const int>(n), 100);
+  EXPECT_DEATH(ca.get<int>(n), "");
+
+  auto grid = compile_path<node>("grid_[2]");
+  EXPECT_TRUE(grid.is_flat());
+  EXPECT_EQ(grid.get<int>(n), 6);
+
+  auto ins = compile_path<node>("ins_[1].v_");
+  EXPECT_TRUE(ins.is_flat());
+  EXPECT_EQ(ins.get<int>(n), 7);
+
+  auto item = compile_path<node>("items_[1].v_");
+  ASSERT_FALSE(item.is_null());
+  EXPECT_FALSE(item.is_flat());
+  EXPECT_EQ(item.get<int>(n), 9);
+  EXPECT_EQ(compile_path<node>("items_[0].tag_").get<std::string>(n), "a");
+
+  // an index past the end of a container is only known when evaluating
+  auto past = compile_path<node>("items_[2].v_");
+  ASSERT_FALSE(past.is_null());
+  EXPECT_EQ(past.try_get<int>(n), nullptr);
+  EXPECT_EQ(item.try_get<int>(n), &n.items_[1].v_);
+  EXPECT_DEATH(past.get<int>(n), "");
+
+  // std::vector<bool> has no element to point at
+  EXPECT_TRUE(compile_path<node>("flags_[0]").is_null());
+  EXPECT_TRUE(compile_path<node>("items_[18446744073709551617].v_").is_null());
+
+  EXPECT_TRUE(compile_path<node>("s_.x_").is_null());
+  EXPECT_TRUE(compile_path<node>("id_.i_").is_null());
+  EXPECT_TRUE(compile_path<node>("grid_[4]").is_null());
+  EXPECT_TRUE(compile_path<node>("items_[").is_null());
+  EXPECT_TRUE(compile_path<node>("s_..a_").is_null());
+}
+
+struct nd
+{
+  nd(int _v) : v_(_v) {}
+  int v_;
+};
+
+struct bag
+{
+  std::vector<nd> nds_;
+  std::vector<int> ints_;
+  std::list<inner> inners_;
+  std::set<int> ids_;
+  const std::vector<int> c_ints_ = { 1, 2 };
+  int n_ = 0;
+
+  static inline std::vector<double> weights_;
+};
+
+TR_INIT(bag)
+{
+  TR_PROPERTY(nds_);
+  TR_PROPERTY(ints_);
+  TR_PROPERTY(inners_);
+  TR_PROPERTY(ids_);
+  TR_PROPERTY(c_ints_);
+  TR_PROPERTY(n_);
+  TR_PROPERTY(weights_);
+}
+
+TEST(TrInfo, ContainerView)
+{
+  bag b;
+
+  auto ints = tr_data<bag>.get_property("ints_").view(b);
+  ASSERT_FALSE(ints.is_null());
+  EXPECT_TRUE(ints.is_contiguous());
+  EXPECT_TRUE(ints.get_elem_desc().can_conv_to(get_type_desc<int>()));
+  EXPECT_EQ(ints.get_elem_size(), sizeof(int));
+
+  int src[] = { 1, 2, 3 };
+  ints.append(src, 3);
+  EXPECT_EQ(b.ints_, (std::vector<int>{ 1, 2, 3 }));
+  EXPECT_EQ(ints.data(), b.ints_.data());
+  EXPECT_EQ(ints.data_as<int>()[2], 3);
+  ints.mutable_data_as<int>()[2] = 4;
+  EXPECT_EQ(b.ints_[2], 4);
+
+  ints.resize(5);
+  EXPECT_EQ(ints.size(), 5u);
+
+  auto inners = tr_data<bag>.get_property("inners_").view(b);
+  EXPECT_FALSE(inners.is_contiguous());
+  EXPECT_EQ(inners.data(), nullptr);
+  inners.resize(2);
+  EXPECT_EQ(b.inners_.size(), 2u);
+
+  auto ids = tr_data<bag>.get_property("ids_").view(b);
+  ids.append(src, 3);
+  ids.append(src, 2);
+  EXPECT_EQ(ids.size(), 3u);
+
+  int sum = 0;
+  ids.for_each([&](const void *_e) { sum += *(const int *)_e; });
+  EXPECT_EQ(sum, 6);
+
+  auto c_ints = tr_data<bag>.get_property("c_ints_").view(b);
+  EXPECT_TRUE(c_ints.is_const());
+  EXPECT_EQ(c_ints.data(), b.c_ints_.data());
+  EXPECT_EQ(c_ints.data_as<int>()[1], 2);
+  EXPECT_DEATH(c_ints.mutable_data(), "");
+  EXPECT_DEATH(c_ints.resize(0), "");
+
+  // an element type that can't be default constructed still gets a view
+  auto nds = tr_data<bag>.get_property("nds_").view(b);
+  nd n[] = { 1, 2 };
+  nds.append(n, 2);
+  EXPECT_EQ(b.nds_.size(), 2u);
+  EXPECT_DEATH(nds.resize(0), "");
+
+  const bag &c_b = b;
+  EXPECT_TRUE(tr_data<bag>.get_property("ints_").view(c_b).is_const());
+
+  EXPECT_TRUE(tr_data<bag>.get_property("n_").view(b).is_null());
+
+  auto weights = tr_data<bag>.get_property("weights_").view();
+  double w = 0.5;
+  weights.append(&w, 1);
+  EXPECT_EQ(bag::weights_.size(), 1u);
+}
@@ -0,0 +1,187 @@
+#include <cpptr_expr.h>
+#include <gtest/gtest.h>
+
+struct pos
+{
+  int i_;
+};
+
+TR_INIT(pos)
+{
+  TR_PROPERTY(i_);
+}
+
+struct box
+{
+  int get_id() const { return id_; }
+  pos get_v() { return v_; }
+
+  int id_ = 0;
+  pos v_ = {};
+};
+
+TR_INIT(box)
+{
+  TR_METHOD(get_id);
+  TR_METHOD(get_v);
+
+  TR_PROPERTY(id_);
+  TR_PROPERTY(v_);
+}
+
+struct unit
+{
+  pos get_a() { return a_; }
+  const pos &get_c() const { return c_a_; }
+  double ratio() const { return ratio_; }
+  uint64_t get_id() const { return id_; }
+  void reset() {}
+
+  pos a_ = {};
+  const pos c_a_ = { 100 };
+  double ratio_ = 0.5;
+  uint64_t id_ = 0;
+  bool alive_ = true;
+  short hp_[3] = {};
+  std::vector<pos> path_;
+  std::vector<box> boxes_;
+};
+
+TR_INIT(unit)
+{
+  TR_METHOD(get_a);
+  TR_METHOD(get_c);
+  TR_METHOD(ratio);
+  TR_METHOD(get_id);
+  TR_METHOD(reset);
+
+  TR_PROPERTY(a_);
+  TR_PROPERTY(c_a_);
+  TR_PROPERTY(ratio_);
+  TR_PROPERTY(id_);
+  TR_PROPERTY(alive_);
+  TR_PROPERTY(hp_);
+  TR_PROPERTY(path_);
+  TR_PROPERTY(boxes_);
+}
+
+class Expr : public testing::Test {
+protected:
+  virtual void SetUp()
+  {
+    u_.a_.i_ = 20;
+    u_.hp_[1] = 7;
+    u_.path_ = { { 1 }, { 2 } };
+    u_.boxes_ = { { 3, { 4 } } };
+  }
+
+  unit u_;
+};
+
+TEST_F(Expr, Member)
+{
+  auto e = compile_expr<unit>("obj.get_a().i_ > 10 && obj.c_a_.i_ < 200");
+  ASSERT_FALSE(e.is_null()) << e.get_error();
+  EXPECT_EQ(e.get_kind(), scalar_kind::boolean);
+  EXPECT_TRUE(e.eval<bool>(u_));
+
+  u_.a_.i_ = 5;
+  EXPECT_FALSE(e.eval<bool>(u_));
+
+  EXPECT_EQ(compile_expr<unit>("obj.hp_[1] * 2 + obj.path_[1].i_").eval<int>(u_), 16);
+  EXPECT_EQ(compile_expr<unit>("obj.get_c().i_").eval<int>(u_), 100);
+  EXPECT_EQ(compile_expr<unit>("obj.ratio() * 4").eval<double>(u_), 2.0);
+  EXPECT_TRUE(compile_expr<unit>("obj.alive_ && !(obj.ratio_ > 1)").eval<bool>(u_));
+  EXPECT_EQ(compile_expr<unit>("u.a_.i_", "u").eval<int>(u_), 5);
+
+  EXPECT_EQ(compile_expr<unit>("obj.boxes_[0].get_id() + obj.boxes_[0].get_v().i_").eval<int>(u_), 7);
+
+  // past the end of path_ only that load reads as 0
+  EXPECT_TRUE(compile_expr<unit>("obj.path_[2].i_ == 0").eval<bool>(u_));
+  EXPECT_EQ(compile_expr<unit>("obj.path_[5].i_ + 1").eval<int>(u_), 1);
+  EXPECT_TRUE(compile_expr<unit>("obj.path_[5].i_ > 0 || obj.alive_").eval<bool>(u_));
+  EXPECT_TRUE(compile_expr<unit>("!(obj.path_[5].i_ > 0)").eval<bool>(u_));
+  EXPECT_EQ(compile_expr<unit>("obj.boxes_[3].get_id() + obj.boxes_[3].get_v().i_ + obj.boxes_[3].v_.i_ + obj.hp_[1]").eval<int>(u_), 7);
+}
+
+TEST_F(Expr, Arith)
+{
+  EXPECT_EQ(compile_expr<unit>("1 + 2 * 3 - 4 / 2").eval<int>(u_), 5);
+  EXPECT_EQ(compile_expr<unit>("(1 + 2) * 3 % 4").eval<int>(u_), 1);
+  EXPECT_EQ(compile_expr<unit>("-obj.a_.i_ + 0.5").eval<double>(u_), -19.5);
+  EXPECT_EQ(compile_expr<unit>("7 / 0").eval<int>(u_), 0);
+  EXPECT_TRUE(compile_expr<unit>("1 < 2 && 2 <= 2 && 3 > 2 && 3 >= 3 && 1 == 1 && 1 != 2").eval<bool>(u_));
+  EXPECT_TRUE(compile_expr<unit>("false || 2.5 >= 2").eval<bool>(u_));
+  EXPECT_FALSE(compile_expr<unit>("true && 0").eval<bool>(u_));
+}
+
+TEST_F(Expr, Unsigned)
+{
+  u_.id_ = UINT64_MAX - 1;
+
+  auto e = compile_expr<unit>("obj.id_ > 10");
+  EXPECT_EQ(compile_expr<unit>("obj.id_").get_kind(), scalar_kind::unsigned_integer);
+  EXPECT_TRUE(e.eval<bool>(u_));
+  EXPECT_TRUE(compile_expr<unit>("obj.get_id() > 9223372036854775807").eval<bool>(u_));
+  EXPECT_EQ(compile_expr<unit>("obj.id_ / 2").eval<uint64_t>(u_), UINT64_MAX / 2);
+  EXPECT_EQ(compile_expr<unit>("obj.id_ + 1").eval<uint64_t>(u_), UINT64_MAX);
+  EXPECT_EQ(compile_expr<unit>("18446744073709551615").eval<uint64_t>(u_), UINT64_MAX);
+  EXPECT_GT(compile_expr<unit>("obj.id_ * 1.0").eval<double>(u_), 1e19);
+
+  EXPECT_TRUE(compile_expr<unit>("18446744073709551616").is_null());
+  EXPECT_TRUE(compile_expr<unit>("1e999").is_null());
+}
+
+TEST_F(Expr, Const)
+{
+  const unit &c = u_;
+
+  auto e = compile_expr<unit>("obj.get_c().i_ + obj.ratio() * 2");
+  EXPECT_FALSE(e.is_mutating());
+  EXPECT_EQ(e.eval<int>(c), 101);
+
+  const unit *ptrs[] = { &u_, &u_ };
+  int vals[2];
+  e.eval(ptrs, 2, vals);
+  EXPECT_EQ(vals[1], 101);
+
+  EXPECT_TRUE(compile_expr<unit>("obj.get_a().i_").is_mutating());
+}
+
+TEST_F(Expr, Batch)
+{
+  std::vector<unit> units(4);
+  for (size_t i = 0; i < units.size(); ++i)
+    units[i].a_.i_ = (int)i * 10;
+
+  auto e = compile_expr<unit>("obj.get_a().i_ >= 15");
+  bool out[4];
+  e.eval(units.data(), units.size(), out);
+  EXPECT_FALSE(out[0]);
+  EXPECT_FALSE(out[1]);
+  EXPECT_TRUE(out[2]);
+  EXPECT_TRUE(out[3]);
+
+  unit *ptrs[] = { &units[3], &units[0] };
+  int vals[2];
+  compile_expr<unit>("obj.a_.i_ + 1").eval(ptrs, 2, vals);
+  EXPECT_EQ(vals[0], 31);
+  EXPECT_EQ(vals[1], 1);
+}
+
+TEST_F(Expr, Error)
+{
+  EXPECT_TRUE(compile_expr<unit>("obj.b_ > 1").is_null());
+  EXPECT_TRUE(compile_expr<unit>("obj.a_ > 1").is_null());
+  EXPECT_TRUE(compile_expr<unit>("obj.nope() > 1").is_null());
+  EXPECT_TRUE(compile_expr<unit>("obj.reset()").is_null());
+  EXPECT_TRUE(compile_expr<unit>("obj.ratio().x_").is_null());
+  EXPECT_TRUE(compile_expr<unit>("x + 1").is_null());
+  EXPECT_TRUE(compile_expr<unit>("1 +").is_null());
+  EXPECT_TRUE(compile_expr<unit>("(1").is_null());
+  EXPECT_TRUE(compile_expr<unit>("1.5 % 2").is_null());
+  EXPECT_TRUE(compile_expr<unit>("obj.c_a_.get_a()").is_null());
+
+  auto e = compile_expr<unit>("obj.a_.j_");
+  EXPECT_FALSE(e.get_error().empty());
+}
@@ -144,4 +144,15 @@ TEST_F(TypeDesc, Misc)
   EXPECT_TRUE(p_lr_i_.can_conv_to(c_p_lr_i_));
   EXPECT_FALSE(p_c_lr_i_.can_conv_to(c_p_lr_i_));
   EXPECT_TRUE(c_p_lr_i_.can_conv_to(c_p_lr_i_));
-}
\ No newline at end of file
+}
+
+TEST_F(TypeDesc, AccessIndex)
+{
+  EXPECT_EQ(lr_i_.get_access_index(), 0u);
+  EXPECT_EQ(c_lr_i_.get_access_index(), 1u);
+  EXPECT_EQ(get_type_desc<volatile st &>().get_access_index(), 2u);
+  EXPECT_EQ(get_type_desc<const volatile st &>().get_access_index(), 3u);
+  EXPECT_EQ(rr_i_.get_access_index(), 4u);
+  EXPECT_EQ(c_rr_i_.get_access_index(), 5u);
+  EXPECT_EQ(i_.get_access_index(), 4u);
+}